@@ -44,53 +44,33 @@ ScreenPoint::ScreenPoint(int16_t x0, int16_t y0, int16_t z0) {
 // Note - For Griduino, if this function takes longer than 8 msec it can cause erratic GPS readings
 // so we recommend against using https://forum.arduino.cc/index.php?topic=449719.0
 bool Resistive_Touch_Screen::isTouching(void) {
-  static bool button_state = false;
-  uint16_t pres_val        = pressure();
-
-  if ((button_state == false) && (pres_val > _start_touch_pressure)) {
-    button_state = true;
-    // Serial.print(". pressed, pressure = ");   // debug
-    // Serial.println(pres_val);                 // debug
-  }
-
-  if ((button_state == true) && (pres_val < _stop_touch_pressure)) {
-    button_state = false;
-    // Serial.print(". released, pressure = ");   // debug
-    // Serial.println(pres_val);                  // debug
-  }
-
-  return button_state;
+  _buttonState = applyHysteresis(_buttonState, pressure());
+  return _buttonState;
 }
 
 // find leading edge of a screen touch, nonblocking
 // returns TRUE only once on initial screen press
 // and then returns FALSE until pressure is released and screen is touched again
 // if true, also return screen coordinates of the touch
-// orientation = 1 or 3 = ILI9341 screen rotation setting in landscape only
+// orientation = 0..3 = ILI9341 screen rotation setting
 bool Resistive_Touch_Screen::newScreenTap(ScreenPoint *screen, uint16_t orientation) {
-
-  static bool gTouching = false;   // keep track of previous state
-
   bool result = false;   // assume no touch
-  if (gTouching) {
+  if (_tapTouching) {
     // the touch was previously processed, so ignore continued pressure until they let go
     if (!isTouching()) {
       // Touching ==> Not Touching transition
-      gTouching = false;
+      _tapTouching = false;
     }
   } else {
     // here, we know the screen was not being touched in the last pass,
     // so look for a new touch on this pass
     // Our replacement "isTouching" function has built-in hysteresis to debounce
-    if (isTouching()) {
-      gTouching = true;
-      result    = true;
-
-      // touchscreen point object has (x,y,z) coordinates, where x,y = resistance, and z = pressure
-      PressPoint touchOhms;
-      touchOhms.x = readTouchX();
-      touchOhms.y = readTouchY();
-      touchOhms.z = pressure();
+    // touchscreen point object has (x,y,z) coordinates, where x,y = resistance, and z = pressure
+    PressPoint touchOhms;
+    if (isTouching() && sampleValidated(&touchOhms)) {
+      _tapTouching = true;
+      result       = true;
+      RTS_COUNT(taps);
 
       // convert resistance measurements into screen pixel coords
       mapTouchToScreen(touchOhms, screen, orientation);
@@ -103,15 +83,15 @@ bool Resistive_Touch_Screen::newScreenTap(ScreenPoint *screen, uint16_t orientat
   // Because LCD may use the same pins
   // todo - is this actually necessary?
   /*
-  pinMode(_x_minus_pin, OUTPUT);
-  pinMode(_x_plus_pin, OUTPUT);
-  pinMode(_y_minus_pin, OUTPUT);
-  pinMode(_y_plus_pin, OUTPUT);
-
-  digitalWrite(_x_minus_pin, LOW);
-  digitalWrite(_y_plus_pin, HIGH);
-  digitalWrite(_y_minus_pin, LOW);
-  digitalWrite(_x_plus_pin, HIGH);
+  setPlateMode(TouchHal::XM, OUTPUT);
+  setPlateMode(TouchHal::XP, OUTPUT);
+  setPlateMode(TouchHal::YM, OUTPUT);
+  setPlateMode(TouchHal::YP, OUTPUT);
+
+  setPlateLevel(TouchHal::XM, LOW);
+  setPlateLevel(TouchHal::YP, HIGH);
+  setPlateLevel(TouchHal::YM, LOW);
+  setPlateLevel(TouchHal::XP, HIGH);
   */
 
   return result;
@@ -121,6 +101,7 @@ bool Resistive_Touch_Screen::newScreenTap(ScreenPoint *screen, uint16_t orientat
  * @brief Convert from X+,Y+ resistance measurements to screen coordinates
  * @param touchOhms = resistance readings from touchscreen
  * @param screenCoord = result of converting touchOhms into screen coordinates
+ * @param orientation = ILI9341 screen rotation 0..3
  **/
 //
 void Resistive_Touch_Screen::mapTouchToScreen(PressPoint touchOhms, ScreenPoint *screenCoord, int orientation) {
@@ -135,30 +116,27 @@ void Resistive_Touch_Screen::mapTouchToScreen(PressPoint touchOhms, ScreenPoint
   //
   // Typical measured pressures=200..600
 
-  switch (orientation) {
-  case 1:   // LANDSCAPE
-    // setRotation(1) = landscape orientation = x-,y-axis exchanged
-    //               map(value        in_min,in_max,          out_min,out_max)
-    screenCoord->x = map(touchOhms.y, _y_min_ohms, _y_max_ohms, 0, _width);
-    screenCoord->y = map(touchOhms.x, _x_max_ohms, _x_min_ohms, 0, _height);
-    screenCoord->z = touchOhms.z;
-    break;
-
-  case 3:   // FLIPPED_LANDSCAPE
-    // setRotation(3) = upside down landscape orientation = x-,y-axis exchanged
-    //               map(value        in_min,in_max,          out_min,out_max)
-    screenCoord->x = map(touchOhms.y, _x_max_ohms, _x_min_ohms, 0, _width);
-    screenCoord->y = map(touchOhms.x, _y_min_ohms, _y_max_ohms, 0, _height);
-    screenCoord->z = touchOhms.z;
-    break;
-
-  default:
-    Serial.println("Portrait orientation is not implemented.");
-    screenCoord->x = random(0, _width);
-    screenCoord->y = random(0, _height);
-    screenCoord->z = touchOhms.z;
-    break;
+  RTS_TIMER_START(start);
+  if (orientation == _matrixOrientation) {
+    // calibrated: one affine transform handles scale, offset, rotation and skew
+    _matrix.apply(touchOhms, screenCoord);
+  } else {
+    // uncalibrated: the transform is derived from the resistance range once per orientation
+    if (orientation != _xformOrientation) {
+      buildTransform(orientation);
+    }
+    if (_lutX) {
+      screenCoord->x = lookup(_lutX, _lutFromY[0] ? touchOhms.y : touchOhms.x);
+      screenCoord->y = lookup(_lutY, _lutFromY[1] ? touchOhms.y : touchOhms.x);
+    } else {
+      _xform.apply(touchOhms, screenCoord);
+    }
   }
+  if (_grid && orientation == _gridOrientation) {
+    // nonlinear film: add the offset interpolated from the correction grid
+    _grid->apply(screenCoord, _gridScaleX, _gridScaleY);
+  }
+  screenCoord->z = touchOhms.z;
 
   // debug
   /*
@@ -176,26 +154,137 @@ void Resistive_Touch_Screen::mapTouchToScreen(PressPoint touchOhms, ScreenPoint
   // keep all touches within boundaries of the screen coordinates
   screenCoord->x = constrain(screenCoord->x, 0, _width);
   screenCoord->y = constrain(screenCoord->y, 0, _height);
+  RTS_TIMER_STOP(start, MAP);
 
   return;
 }
 
 /**
- * @brief Helper function for getPoint()
+ * @brief Build the touch-to-screen transform for one screen orientation
+ *
+ * Each ILI9341 rotation takes screen x and y from one touch axis each, possibly reversed:
+ *
+ *   rotation             screen x from   screen y from
+ *   0 portrait           X               Y
+ *   1 landscape          Y               X reversed
+ *   2 flipped portrait   X reversed      Y reversed
+ *   3 flipped landscape  Y reversed      X
  *
- * @param array
- * @param size
+ * The scale factors are computed here so mapping a touch needs no division.
+ * If lookup tables were given to setLookupTables(), they are filled here too.
+ * A rotation change builds them on the next touch; setScreenSize(),
+ * setResistanceRange() and setLookupTables() rebuild them at once.
  */
-void Resistive_Touch_Screen::insert_sort(uint16_t array[], uint8_t size) {
-  uint8_t j;
-  uint16_t save;
+void Resistive_Touch_Screen::buildTransform(int orientation) {
+  const uint8_t FROM_Y   = 1;   // screen axis is taken from the touch Y axis
+  const uint8_t REVERSED = 2;   // screen axis runs from max to min resistance
+  static const uint8_t rules[4][2] = {
+      {0, FROM_Y},                     // 0 = PORTRAIT
+      {FROM_Y, REVERSED},              // 1 = LANDSCAPE
+      {REVERSED, FROM_Y | REVERSED},   // 2 = FLIPPED_PORTRAIT
+      {FROM_Y | REVERSED, 0},          // 3 = FLIPPED_LANDSCAPE
+  };
+  const uint8_t *rule = rules[orientation & 3];
 
-  for (int i = 1; i < size; i++) {
-    save = array[i];
-    for (j = i; j >= 1 && save < array[j - 1]; j--)
-      array[j] = array[j - 1];
-    array[j] = save;
+  int32_t coef[2][3];   // rows of the matrix for screen x and screen y
+  uint16_t extent[2] = {_width, _height};
+  for (uint8_t axis = 0; axis < 2; axis++) {
+    bool fromY   = rule[axis] & FROM_Y;
+    int32_t lo   = fromY ? _y_min_ohms : _x_min_ohms;
+    int32_t hi   = fromY ? _y_max_ohms : _x_max_ohms;
+    int32_t span = (hi > lo) ? (hi - lo) : 1;
+
+    // scale = extent / span in 16-bit fixed point, rounded to nearest
+    int32_t scale = (((int32_t)extent[axis] << TouchMatrix::FRACTION_BITS) + span / 2) / span;
+    int32_t start = lo;
+    if (rule[axis] & REVERSED) {
+      scale = -scale;
+      start = hi;
+    }
+    coef[axis][0] = fromY ? 0 : scale;
+    coef[axis][1] = fromY ? scale : 0;
+    coef[axis][2] = -start * scale;
+
+    int16_t *table = axis ? _lutY : _lutX;
+    if (table) {
+      // screen coordinate at every step of touch resistance, in 1/16 pixels
+      const uint8_t shift = TouchMatrix::FRACTION_BITS - LUT_FRACTION_BITS;
+      for (uint16_t ii = 0; ii <= (1024 >> _lutShift); ii++) {
+        int64_t q = (int64_t)((ii << _lutShift) - start) * scale;
+        q         = (q + ((int64_t)1 << (shift - 1))) >> shift;
+        table[ii] = (int16_t)constrain(q, INT16_MIN, INT16_MAX);   // far outside the range on a narrow span
+      }
+      _lutFromY[axis] = fromY;
+    }
   }
+
+  _xform.a          = coef[0][0];
+  _xform.b          = coef[0][1];
+  _xform.c          = coef[0][2];
+  _xform.d          = coef[1][0];
+  _xform.e          = coef[1][1];
+  _xform.f          = coef[1][2];
+  _xformOrientation = orientation;
+}
+
+/**
+ * @brief Rebuild the transform after a setting changed, for the orientation last mapped
+ *
+ * Doing it here keeps the table fill, which takes up to 2050 entries, out of
+ * the first touch after the change. Before the first touch there is nothing
+ * to rebuild.
+ */
+void Resistive_Touch_Screen::rebuildTransform(void) {
+  if (_xformOrientation != NO_ORIENTATION) {
+    buildTransform(_xformOrientation);
+  }
+}
+
+/**
+ * @brief Use caller-supplied lookup tables for the resistance-range mapping
+ *
+ * Each table holds the screen coordinate for evenly spaced touch measurements,
+ * so mapping takes two table loads, plus a linear interpolation between
+ * neighbouring entries when a table has fewer than 1024 entries. The tables
+ * are filled here and by setScreenSize() and setResistanceRange() for the
+ * orientation last used, and on the first touch in a new orientation. The
+ * affine calibration from setCalibration() does not use them.
+ *
+ * @param x_table, y_table = buffers of entries + 1 values each, owned by the caller;
+ *                           nullptr turns the tables off
+ * @param entries = 16, 32, 64, 128, 256, 512 or 1024
+ * @return false if entries is not supported; the tables are then turned off
+ */
+bool Resistive_Touch_Screen::setLookupTables(int16_t *x_table, int16_t *y_table, uint16_t entries) {
+  _lutX = nullptr;
+  _lutY = nullptr;
+  if (x_table == nullptr || y_table == nullptr) {
+    return x_table == y_table;
+  }
+  for (uint8_t shift = 0; shift <= 6; shift++) {
+    if (entries == (1024 >> shift)) {
+      _lutX     = x_table;
+      _lutY     = y_table;
+      _lutShift = shift;
+      rebuildTransform();
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Screen coordinate of a touch measurement, from a table built by buildTransform()
+ */
+int16_t Resistive_Touch_Screen::lookup(const int16_t *table, int16_t touch) const {
+  uint16_t t    = constrain(touch, 0, 1023);
+  uint16_t ii   = t >> _lutShift;
+  int32_t value = table[ii];
+  if (_lutShift) {
+    int32_t frac = t & ((1 << _lutShift) - 1);
+    value += ((table[ii + 1] - value) * frac) >> _lutShift;
+  }
+  return (int16_t)((value + (1 << (LUT_FRACTION_BITS - 1))) >> LUT_FRACTION_BITS);
 }
 
 /**
@@ -203,39 +292,66 @@ void Resistive_Touch_Screen::insert_sort(uint16_t array[], uint8_t size) {
  * @return TSPoint
  */
 TSPoint Resistive_Touch_Screen::getPoint() {
-  // read 1 sample of X,Y
   TSPoint ret;
-  ret.x = readTouchX();
-  ret.y = readTouchY();
+  ret.x = sampleX();
+  ret.y = sampleY();
 
-  // read 3 samples of Z pressure, return the median
-  // Note: 
+  // Note:
   // Z measurements while using light steady pressure is extremely noisy, with
   // almost half the samples randomly returning zero pressure.
   // Adafruit has apparently struggled with this too; their driver has options
   // for 'oversampling' based on compile-time directive NUMSAMPLES and "insert_sort".
   // However, the implementation suffers overflow and returns wildly random negative
   // numbers instead of 0..1023. It doesn't appear to be fully debugged.
-  // We need to ignore outliers of Z pressure, but Adafruit's oversampling is 
-  // unreliable, so we re-implement a fully tested routine here.
-  uint16_t p[3];
-  p[0] = pressure();
-  p[1] = pressure();
-  p[2] = pressure();
-
-  // sort the 3 measurements; median is the middle element
-  insert_sort(p, 3);
-  ret.z = p[1];
-
-  /*** debug
-  char msg[128];
-  snprintf(msg, sizeof(msg), "Pressure: %d, %d, %d", p[0], p[1], p[2]);
-  Serial.println(msg);
-  ***/
+  // We need to ignore outliers of Z pressure, so by default we take the median
+  // of 3 samples; see setOversampling() and Touch_Filters.h.
+  ret.z = samplePressure(ret.x);
 
   return ret;
 }
 
+/**
+ * @brief Configure how many samples are combined into each X,Y and Z measurement
+ *
+ * @param xy_samples 1, 3, 5, 7 or 9 samples of each of X and Y (default 1)
+ * @param z_samples  1, 3, 5, 7 or 9 samples of Z pressure (default 3)
+ * @param reducer    TouchFilter::MEDIAN, TRIMMED_MEAN or MINMAX_MEAN (default MEDIAN)
+ */
+void Resistive_Touch_Screen::setOversampling(uint8_t xy_samples, uint8_t z_samples, uint8_t reducer) {
+  _xySamples = TouchFilter::supportedCount(xy_samples);
+  _zSamples  = TouchFilter::supportedCount(z_samples);
+  _reducer   = reducer;
+  _count     = 0;          // samples of the old size must not be combined with the new
+  _phase     = PHASE_Z1;   // so restart the cycle poll() has in progress
+}
+
+/**
+ * @brief Oversampled measurements, combined with the configured reducer
+ */
+int Resistive_Touch_Screen::sampleX(void) {
+  uint16_t v[TouchFilter::MAX_SAMPLES];
+  for (uint8_t ii = 0; ii < _xySamples; ii++) {
+    v[ii] = readTouchX();
+  }
+  return reduce(v, _xySamples);
+}
+
+int Resistive_Touch_Screen::sampleY(void) {
+  uint16_t v[TouchFilter::MAX_SAMPLES];
+  for (uint8_t ii = 0; ii < _xySamples; ii++) {
+    v[ii] = readTouchY();
+  }
+  return reduce(v, _xySamples);
+}
+
+uint16_t Resistive_Touch_Screen::samplePressure(int x) {
+  uint16_t v[TouchFilter::MAX_SAMPLES];
+  for (uint8_t ii = 0; ii < _zSamples; ii++) {
+    v[ii] = pressureAt(x);
+  }
+  return reduce(v, _zSamples);
+}
+
 /**
  * @brief Read the touch event's X value
  *
@@ -244,17 +360,8 @@ TSPoint Resistive_Touch_Screen::getPoint() {
  * (Copied from Adafruit_Touchscreen)
  */
 int Resistive_Touch_Screen::readTouchX(void) {
-  pinMode(_y_plus_pin, INPUT);
-  pinMode(_y_minus_pin, INPUT);
-  digitalWrite(_y_plus_pin, LOW);
-  digitalWrite(_y_minus_pin, LOW);
-
-  pinMode(_x_plus_pin, OUTPUT);
-  digitalWrite(_x_plus_pin, HIGH);
-  pinMode(_x_minus_pin, OUTPUT);
-  digitalWrite(_x_minus_pin, LOW);
-
-  return (1023 - analogRead(_y_plus_pin));
+  driveX();
+  return (1023 - convert(TouchHal::YP));
 }
 
 /**
@@ -265,48 +372,663 @@ int Resistive_Touch_Screen::readTouchX(void) {
  * @return int the Y measurement
  */
 int Resistive_Touch_Screen::readTouchY(void) {
-  pinMode(_x_plus_pin, INPUT);
-  pinMode(_x_minus_pin, INPUT);
-  digitalWrite(_x_plus_pin, LOW);
-  digitalWrite(_x_minus_pin, LOW);
+  driveY();
+  return (1023 - convert(TouchHal::XM));
+}
+
+/**
+ * @brief Change a plate's pin mode, skipping the hardware if it is already in that mode
+ *
+ * Note: analogRead() on some cores switches the pin to its analog function. That only
+ * happens to pins we already hold as INPUT, and analog is high impedance too, so the
+ * cached INPUT state remains correct. A change to OUTPUT always reaches the hardware.
+ */
+void Resistive_Touch_Screen::setPlateMode(uint8_t plate, uint8_t mode) {
+  if (_plateMode[plate] == mode) {
+    _pinSkipped++;
+    return;
+  }
+  _plateMode[plate] = mode;
+  _pinExecuted++;
+  _hal->setPinMode(plate, mode);
+}
+
+/**
+ * @brief Change a plate's output level, skipping the hardware if it is already at that level
+ */
+void Resistive_Touch_Screen::setPlateLevel(uint8_t plate, uint8_t level) {
+  if (_plateLevel[plate] == level) {
+    _pinSkipped++;
+    return;
+  }
+  _plateLevel[plate] = level;
+  _pinExecuted++;
+  _hal->writePin(plate, level);
+}
+
+/**
+ * @brief Forget the cached pin states, so the next phase reprograms every pin
+ */
+void Resistive_Touch_Screen::resetPinCache(void) {
+  for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+    _plateMode[plate]  = PIN_UNKNOWN;
+    _plateLevel[plate] = PIN_UNKNOWN;
+  }
+  _drivenPhase = TouchHal::NUM_PHASES;
+}
+
+/**
+ * @brief One analog conversion on a plate
+ */
+int Resistive_Touch_Screen::convert(uint8_t plate) {
+  RTS_TIMER_START(start);
+  int value = _hal->readPin(plate);
+  RTS_TIMER_STOP(start, CONVERT);
+  return value;
+}
+
+/**
+ * @brief Combine oversampled values with the configured reducer
+ */
+uint16_t Resistive_Touch_Screen::reduce(uint16_t v[], uint8_t n) {
+  RTS_TIMER_START(start);
+  uint16_t value = TouchFilter::reduce(v, n, _reducer);
+  RTS_TIMER_STOP(start, FILTER);
+  return value;
+}
+
+/**
+ * @brief Switch every plate to a phase with one TouchHal::drivePhase() call, if the
+ *        backend has one, keeping the pin cache and its counters as setPlateMode()
+ *        and setPlateLevel() would
+ * @return false if the backend switches one plate at a time; use those instead
+ */
+bool Resistive_Touch_Screen::drivePlates(uint8_t phase) {
+  if (!_halDrivesPhases) {
+    return false;
+  }
+  uint8_t outputs = TouchHal::phaseOutputs(phase);
+  uint8_t highs   = TouchHal::phaseHighs(phase);
+  uint8_t changes = 0;
+  for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+    changes += (_plateMode[plate] != ((outputs & (1 << plate)) ? OUTPUT : INPUT));
+    changes += (_plateLevel[plate] != ((highs & (1 << plate)) ? HIGH : LOW));
+  }
+  if (changes && !_hal->drivePhase(phase, _drivenPhase)) {
+    _halDrivesPhases = false;   // ask once, the backend does not change
+    return false;
+  }
+  _drivenPhase = phase;
+  for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+    _plateMode[plate]  = (outputs & (1 << plate)) ? OUTPUT : INPUT;
+    _plateLevel[plate] = (highs & (1 << plate)) ? HIGH : LOW;
+  }
+  _pinExecuted += changes;
+  _pinSkipped += 2 * TouchHal::NUM_PLATES - changes;
+  return true;
+}
+
+/**
+ * @brief Configure plates to measure X: drive X+ high and X- low, sense on Y+
+ */
+void Resistive_Touch_Screen::driveX(void) {
+  uint32_t before = _pinExecuted;
+  RTS_TIMER_START(start);
+  if (!drivePlates(TouchHal::DRIVE_X)) {
+    setPlateMode(TouchHal::YP, INPUT);
+    setPlateMode(TouchHal::YM, INPUT);
+    setPlateLevel(TouchHal::YP, LOW);
+    setPlateLevel(TouchHal::YM, LOW);
+
+    setPlateMode(TouchHal::XP, OUTPUT);
+    setPlateLevel(TouchHal::XP, HIGH);
+    setPlateMode(TouchHal::XM, OUTPUT);
+    setPlateLevel(TouchHal::XM, LOW);
+  }
+  RTS_TIMER_STOP(start, DRIVE);
+  settle(SETTLE_X, before);
+}
+
+/**
+ * @brief Configure plates to measure Y: drive Y+ high and Y- low, sense on X-
+ */
+void Resistive_Touch_Screen::driveY(void) {
+  uint32_t before = _pinExecuted;
+  RTS_TIMER_START(start);
+  if (!drivePlates(TouchHal::DRIVE_Y)) {
+    setPlateMode(TouchHal::XP, INPUT);
+    setPlateMode(TouchHal::XM, INPUT);
+    setPlateLevel(TouchHal::XP, LOW);
+    setPlateLevel(TouchHal::XM, LOW);
+
+    setPlateMode(TouchHal::YP, OUTPUT);
+    setPlateLevel(TouchHal::YP, HIGH);
+    setPlateMode(TouchHal::YM, OUTPUT);
+    setPlateLevel(TouchHal::YM, LOW);
+  }
+  RTS_TIMER_STOP(start, DRIVE);
+  settle(SETTLE_Y, before);
+}
+
+/**
+ * @brief Configure plates to measure Z: X+ to ground, Y- to VCC, sense Z1 on X- and Z2 on Y+
+ */
+void Resistive_Touch_Screen::drivePressure(void) {
+  uint32_t before = _pinExecuted;
+  RTS_TIMER_START(start);
+  if (!drivePlates(TouchHal::DRIVE_Z)) {
+    // Set X+ to ground
+    setPlateMode(TouchHal::XP, OUTPUT);
+    setPlateLevel(TouchHal::XP, LOW);
+
+    // Set Y- to VCC
+    setPlateMode(TouchHal::YM, OUTPUT);
+    setPlateLevel(TouchHal::YM, HIGH);
+
+    // Hi-Z X- and Y+
+    setPlateLevel(TouchHal::XM, LOW);
+    setPlateMode(TouchHal::XM, INPUT);
+    setPlateLevel(TouchHal::YP, LOW);
+    setPlateMode(TouchHal::YP, INPUT);
+  }
+  RTS_TIMER_STOP(start, DRIVE);
+  settle(SETTLE_Z, before);
+}
+
+/**
+ * @brief Wait for the plates to settle after a drive phase, if any pin actually changed
+ * @param before = value of _pinExecuted before the drive phase began
+ */
+void Resistive_Touch_Screen::settle(uint8_t phase, uint32_t before) {
+  if (_settleUs[phase] && _pinExecuted != before) {
+    RTS_TIMER_START(start);
+    _hal->delayMicroseconds(_settleUs[phase]);
+    RTS_TIMER_STOP(start, SETTLE);
+  }
+}
+
+/**
+ * @brief Find the shortest settling delay of each phase that gives steady readings
+ *
+ * Hold a stylus steadily on the screen while this runs. For each phase (X, Y, Z),
+ * the delay is swept upward from zero. At each step the plates are switched from
+ * another phase and back, and the variance of repeated conversions is measured.
+ * The first delay whose variance is within the target is kept.
+ *
+ * @param variance_target = acceptable variance, in ADC counts squared
+ * @param max_us          = longest delay to try
+ * @return true if every phase reached the target; phases that did not are set to max_us
+ */
+bool Resistive_Touch_Screen::autoTuneSettling(uint16_t variance_target, uint16_t max_us) {
+  const uint8_t REPEATS = 16;
+  const uint8_t steps   = 20;
+  uint16_t step_us      = (max_us + steps - 1) / steps;
+  if (step_us == 0) {
+    step_us = 1;
+  }
+  bool all = true;
+
+  for (uint8_t phase = 0; phase < NUM_SETTLE; phase++) {
+    bool found = false;
+    for (uint32_t us = 0; us <= max_us && !found; us += step_us) {
+      _settleUs[phase] = us;
+      uint32_t sum = 0, squares = 0;
+      for (uint8_t ii = 0; ii < REPEATS; ii++) {
+        int v;
+        switch (phase) {
+        case SETTLE_X:
+          driveY();   // switch away, so driveX() really changes the pins
+          v = readTouchX();
+          break;
+        case SETTLE_Y:
+          driveX();
+          v = readTouchY();
+          break;
+        default:
+          driveX();
+          drivePressure();
+          v = convert(TouchHal::XM);
+          break;
+        }
+        sum += v;
+        squares += (uint32_t)v * v;
+      }
+      // variance = E[v^2] - E[v]^2, scaled by REPEATS^2 to stay in integers
+      uint32_t variance = (squares * REPEATS - sum * sum) / ((uint32_t)REPEATS * REPEATS);
+      found             = (variance <= variance_target);
+    }
+    if (!found) {
+      _settleUs[phase] = max_us;
+      all              = false;
+    }
+  }
+  return all;
+}
+
+/**
+ * @brief Measure a new tap, rejecting readings taken while the stylus lands or lifts off
+ *
+ * X and Y are wildly wrong when pressure is marginal, so they are measured twice,
+ * with a pressure check after each pair. The tap is accepted when pressure stayed
+ * firmer than the start threshold and both pairs agree within _tapTolerance; otherwise
+ * it is measured again, up to _tapRetries more times. If every attempt fails the
+ * caller tries again on its next pass, since the touch has not been reported.
+ *
+ * @return false if no attempt gave a trustworthy measurement
+ */
+bool Resistive_Touch_Screen::sampleValidated(PressPoint *touchOhms) {
+  if (_tapTolerance == 0) {
+    touchOhms->x = sampleX();
+    touchOhms->y = sampleY();
+    touchOhms->z = pressureAt(touchOhms->x);
+    return true;
+  }
 
-  pinMode(_y_plus_pin, OUTPUT);
-  digitalWrite(_y_plus_pin, HIGH);
-  pinMode(_y_minus_pin, OUTPUT);
-  digitalWrite(_y_minus_pin, LOW);
+  for (uint8_t attempt = 0; attempt <= _tapRetries; attempt++) {
+    int x1              = sampleX();
+    int y1              = sampleY();
+    uint16_t pres_first = samplePressure(x1);
+    int x2              = sampleX();
+    int y2              = sampleY();
+    uint16_t pres_last  = samplePressure(x2);
 
-  return (1023 - analogRead(_x_minus_pin));
+    if (firmerThan(pres_first, _start_touch_pressure) && firmerThan(pres_last, _start_touch_pressure) && abs(x1 - x2) <= _tapTolerance && abs(y1 - y2) <= _tapTolerance) {
+      touchOhms->x = (x1 + x2 + 1) / 2;
+      touchOhms->y = (y1 + y2 + 1) / 2;
+      touchOhms->z = pres_last;
+      return true;
+    }
+    RTS_COUNT(rejected);
+  }
+  return false;
 }
 
 // 2020-05-03 CraigV and barry@k7bwh.com
 /**
  * @brief Read the touch event's Z/pressure value
  *
- * @return int the Z measurement
+ * @return int the Z measurement, see computePressure()
  */
 uint16_t Resistive_Touch_Screen::pressure(void) {
-  // Set X+ to ground
-  pinMode(_x_plus_pin, OUTPUT);
-  digitalWrite(_x_plus_pin, LOW);
+  return pressureAt(_rx ? readTouchX() : 0);
+}
 
-  // Set Y- to VCC
-  pinMode(_y_minus_pin, OUTPUT);
-  digitalWrite(_y_minus_pin, HIGH);
+uint16_t Resistive_Touch_Screen::pressureAt(int x) {
+  drivePressure();
 
-  // Hi-Z X- and Y+
-  digitalWrite(_x_minus_pin, LOW);
-  pinMode(_x_minus_pin, INPUT);
-  digitalWrite(_y_plus_pin, LOW);
-  pinMode(_y_plus_pin, INPUT);
+  int z1 = convert(TouchHal::XM);
+  int z2 = convert(TouchHal::YP);
 
-  int z1 = analogRead(_x_minus_pin);
-  int z2 = analogRead(_y_plus_pin);
+  return computePressure(z1, z2, x);
+}
 
-  return (uint16_t)(1023 - (z2 - z1));
+/**
+ * @brief Combine the two Z measurements into a pressure value
+ *
+ * With rx = 0 the result is in ADC counts, 1023 - (Z2 - Z1), and rises with pressure.
+ *
+ * With rx set to the X plate resistance, the result is the touch resistance in ohms,
+ * which falls as the touch gets firmer:
+ *   Rtouch = Rx * X/1024 * (Z2/Z1 - 1) = (Rx * X/1024) * (Z2 - Z1) / Z1
+ * Rx * X fits 26 bits and (Z2 - Z1) 10 bits, so Rx * X/1024 is rounded first to keep
+ * the product in 32 bits, and there is a single division.
+ *
+ * @param x = X measurement of the same touch, only used for ohms
+ * @return pressure in ADC counts, or touch resistance in ohms (NO_CONTACT if not touched)
+ */
+uint16_t Resistive_Touch_Screen::computePressure(int z1, int z2, int x) {
+  if (_rx == 0) {
+    return (uint16_t)(1023 - (z2 - z1));
+  }
+  if (z1 <= 0 || x <= 0) {
+    return NO_CONTACT;   // no current through the contact point
+  }
+  if (z2 <= z1) {
+    return 0;   // noise on a very firm touch
+  }
+  uint32_t rx_x   = ((uint32_t)_rx * (uint32_t)x + 512) >> 10;
+  uint32_t rtouch = rx_x * (uint32_t)(z2 - z1) / (uint32_t)z1;
+  return (rtouch < NO_CONTACT) ? (uint16_t)rtouch : NO_CONTACT - 1;
+}
+
+/**
+ * @brief Restore the default touch thresholds for the units pressure is measured in
+ */
+void Resistive_Touch_Screen::setDefaultThresholds(void) {
+  if (_rx) {
+    setThreshhold(700, 1200);   // touch resistance in ohms
+  } else {
+    setThreshhold(200, 50);   // ADC counts
+  }
+}
+
+/**
+ * @brief Apply start/stop thresholds to a pressure measurement
+ * @param touching = previous state of the touch
+ * @return new state of the touch
+ */
+bool Resistive_Touch_Screen::applyHysteresis(bool touching, uint16_t pres_val) {
+  if (!touching && firmerThan(pres_val, _start_touch_pressure)) {
+    RTS_COUNT(transitions);
+    return true;
+  }
+  if (touching && lighterThan(pres_val, _stop_touch_pressure)) {
+    RTS_COUNT(transitions);
+    return false;
+  }
+  if (!touching && !lighterThan(pres_val, _stop_touch_pressure)) {
+    RTS_COUNT(rejected);   // some pressure, but not enough to start a touch
+  }
+  return touching;
+}
+
+/**
+ * @brief Advance the non-blocking acquisition engine by a single phase
+ *
+ * Each call performs at most one drive-settle-convert step, i.e. one analogRead(),
+ * so the time spent per loop() pass is bounded regardless of touch activity.
+ * A full measurement cycles through Z1, Z2 and, only while touching, X and Y.
+ *
+ * @return true when a complete X,Y,Z sample has just been measured (see lastSample())
+ */
+bool Resistive_Touch_Screen::poll(void) {
+  uint32_t start = _hal->micros();
+  if (_phase == PHASE_Z1) {
+    // a new measurement cycle begins only when the adaptive schedule says it is due
+    if ((start - _cycleStartUs) < (uint32_t)_intervalMs * 1000) {
+      return false;
+    }
+    _cycleStartUs = start;
+  }
+
+  bool complete = pollPhase();
+
+  // duty cycle = time spent measuring / time elapsed, over windows of about one second
+  uint32_t end = _hal->micros();
+  _busyUs += end - start;
+  uint32_t window = end - _windowStartUs;
+  if (window >= 1000000UL) {
+    _dutyPermille  = (uint16_t)(((uint64_t)_busyUs * 1000) / window);
+    _busyUs        = 0;
+    _windowStartUs = end;
+  }
+  return complete;
+}
+
+/**
+ * @brief Configure adaptive polling for poll() and everything built on it
+ *
+ * While nothing touches the screen, each measurement cycle is a single pen-down
+ * conversion (Y- driven high, sensing X-) and the time between cycles doubles after
+ * every idle cycle, up to idle_ms. Once the panel is touched, full cycles run every
+ * active_ms. Set idle_ms to 0 (the default) to measure continuously on every call.
+ *
+ * @param idle_ms   longest time between cycles while the screen is not touched
+ * @param active_ms time between cycles while the screen is touched
+ */
+void Resistive_Touch_Screen::setPollRate(uint16_t idle_ms, uint16_t active_ms) {
+  _idleMs     = idle_ms;
+  _activeMs   = active_ms;
+  _intervalMs = _pollTouching ? active_ms : idle_ms;
+}
+
+/**
+ * @brief Perform one phase of the measurement cycle, see poll()
+ */
+bool Resistive_Touch_Screen::pollPhase(void) {
+  bool complete = false;
+
+  switch (_phase) {
+  case PHASE_Z1:
+    drivePressure();
+    _z1 = convert(TouchHal::XM);
+    if (_idleMs && !_pollTouching && _z1 < _penDownThreshold) {
+      // pen-down check says nothing is on the panel, so this cycle is done: back off
+      uint32_t longer = (uint32_t)_intervalMs * 2;
+      _intervalMs     = constrain(longer, (uint32_t)_activeMs + 1, (uint32_t)_idleMs);
+      break;
+    }
+    _phase = PHASE_Z2;
+    break;
+
+  case PHASE_Z2:
+    // plates are still configured for pressure from the previous phase
+    _z2    = convert(TouchHal::YP);
+    _phase = PHASE_X;
+    if (_rx == 0 || _z1 <= 0) {
+      // decide now; pressure in ohms needs X as well, unless nothing touches at all
+      pollDecide(computePressure(_z1, _z2, 0));
+    }
+    break;
+
+  case PHASE_X:
+    // oversampling takes one call per sample
+    _oversample[_count++] = readTouchX();
+    if (_count >= _xySamples) {
+      _sample.x = reduce(_oversample, _count);
+      _count    = 0;
+      _phase    = PHASE_Y;
+      if (_rx) {
+        pollDecide(computePressure(_z1, _z2, _sample.x));
+      }
+    }
+    break;
+
+  case PHASE_Y:
+    _oversample[_count++] = readTouchY();
+    if (_count >= _xySamples) {
+      _sample.y = reduce(_oversample, _count);
+      _count    = 0;
+      _phase    = PHASE_Z1;
+      complete  = true;
+    }
+    break;
+  }
+  return complete;
+}
+
+/**
+ * @brief Apply hysteresis to the pressure of the cycle in progress, see pollPhase()
+ *
+ * If the touch has ended, the cycle stops here and the next one starts over at Z1.
+ */
+void Resistive_Touch_Screen::pollDecide(uint16_t pres_val) {
+  _sample.z     = pres_val;
+  _pollTouching = applyHysteresis(_pollTouching, pres_val);
+  if (_pollTouching) {
+    _intervalMs = _activeMs;   // sample at the fast rate while touched
+  } else {
+    if (_pollTapReported || _streamDown) {
+      _pollReleased = true;
+    }
+    _pollTapReported = false;   // released, so the next touch is a new tap
+    _phase           = PHASE_Z1;
+  }
+}
+
+/**
+ * @brief Non-blocking equivalent of newScreenTap() built on poll()
+ *
+ * Call this on every pass through loop(). It returns TRUE only once per touch,
+ * after the engine has collected a complete sample of the new touch.
+ */
+bool Resistive_Touch_Screen::pollScreenTap(ScreenPoint *screen, uint16_t orientation) {
+  if (poll() && !_pollTapReported) {
+    _pollTapReported = true;
+    RTS_COUNT(taps);
+    mapTouchToScreen(_sample, screen, orientation);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Non-blocking stream of touch events, built on poll()
+ *
+ * A touch produces one DOWN event, then a MOVE event each time it has travelled at
+ * least the move threshold (see setMoveThreshold()) from the last reported point,
+ * and finally an UP event. Small movements caused by noise are not reported.
+ */
+bool Resistive_Touch_Screen::nextTouchEvent(TouchEvent *pEvent, uint16_t orientation) {
+  bool complete = poll();
+
+  if (_pollReleased) {
+    _pollReleased = false;
+    if (_streamDown) {
+      _streamDown   = false;
+      pEvent->type  = TouchEvent::UP;
+      pEvent->point = _streamLast;
+      pEvent->ms    = _hal->millis();
+      return true;
+    }
+  }
+  if (!complete) {
+    return false;
+  }
+
+  PressPoint sample = _sample;
+  if (!_streamDown) {
+    _smoother.reset();   // a new touch must not be pulled toward where the last one ended
+  }
+  _smoother.apply(&sample.x, &sample.y);
+
+  ScreenPoint screen;
+  mapTouchToScreen(sample, &screen, orientation);
+  if (_streamDown) {
+    int dx = screen.x - _streamLast.x;
+    int dy = screen.y - _streamLast.y;
+    if (abs(dx) < _moveThreshold && abs(dy) < _moveThreshold) {
+      return false;
+    }
+    pEvent->type = TouchEvent::MOVE;
+  } else {
+    _streamDown  = true;
+    pEvent->type = TouchEvent::DOWN;
+    RTS_COUNT(taps);
+  }
+  _streamLast   = screen;
+  pEvent->point = screen;
+  pEvent->ms    = _hal->millis();
+  return true;
+}
+
+/**
+ * @brief Copy the current calibration into a sealed record
+ */
+void Resistive_Touch_Screen::getCalibrationRecord(TouchCalibrationRecord *rec) const {
+  *rec                 = TouchCalibrationRecord();
+  rec->x_min           = _x_min_ohms;
+  rec->x_max           = _x_max_ohms;
+  rec->y_min           = _y_min_ohms;
+  rec->y_max           = _y_max_ohms;
+  rec->rx              = _rx;
+  rec->start_threshold = _start_touch_pressure;
+  rec->stop_threshold  = _stop_touch_pressure;
+  rec->orientation     = _matrixOrientation;
+  rec->matrix[0]       = _matrix.a;
+  rec->matrix[1]       = _matrix.b;
+  rec->matrix[2]       = _matrix.c;
+  rec->matrix[3]       = _matrix.d;
+  rec->matrix[4]       = _matrix.e;
+  rec->matrix[5]       = _matrix.f;
+  rec->seal();
+}
+
+/**
+ * @brief Apply a calibration record; nothing changes if the record is not valid
+ */
+bool Resistive_Touch_Screen::setCalibrationRecord(const TouchCalibrationRecord &rec) {
+  if (!rec.isValid()) {
+    return false;
+  }
+  // range first, since changing rx between zero and non-zero resets the thresholds
+  setResistanceRange(rec.x_min, rec.x_max, rec.y_min, rec.y_max, rec.rx);
+  setThreshhold(rec.start_threshold, rec.stop_threshold);
+  if (rec.orientation == NO_ORIENTATION) {
+    clearCalibration();
+  } else {
+    TouchMatrix m;
+    m.a = rec.matrix[0];
+    m.b = rec.matrix[1];
+    m.c = rec.matrix[2];
+    m.d = rec.matrix[3];
+    m.e = rec.matrix[4];
+    m.f = rec.matrix[5];
+    setCalibration(m, rec.orientation);
+  }
+  return true;
+}
+
+size_t Resistive_Touch_Screen::saveCalibration(uint8_t *blob, size_t size) const {
+  if (size < sizeof(TouchCalibrationRecord)) {
+    return 0;
+  }
+  TouchCalibrationRecord rec;
+  getCalibrationRecord(&rec);
+  memcpy(blob, &rec, sizeof(rec));
+  return sizeof(rec);
+}
+
+bool Resistive_Touch_Screen::loadCalibration(const uint8_t *blob, size_t size) {
+  if (blob == nullptr || size < sizeof(TouchCalibrationRecord)) {
+    return false;
+  }
+  TouchCalibrationRecord rec;
+  memcpy(&rec, blob, sizeof(rec));   // the blob may not be aligned
+  return setCalibrationRecord(rec);
+}
+
+/**
+ * @brief Print the instrumentation histograms and counters, see Touch_Stats.h
+ */
+void Resistive_Touch_Screen::dumpStats(Print &out) {
+#if RTS_INSTRUMENTATION
+  _stats.dump(out);
+#else
+  out.println("Touch screen instrumentation is disabled, see RTS_INSTRUMENTATION in Touch_Stats.h");
+#endif
+}
+
+void Resistive_Touch_Screen::resetStats(void) {
+#if RTS_INSTRUMENTATION
+  _stats.reset();
+#endif
+}
+
+// ========== Class TouchPanelGroup ==========
+/**
+ * @brief Add a touch screen to the group
+ * @param orientation = ILI9341 screen rotation of this panel's display
+ * @return false if the group is full
+ */
+bool TouchPanelGroup::add(Resistive_Touch_Screen *panel, uint16_t orientation) {
+  if (_count >= MAX_PANELS) {
+    return false;
+  }
+  _panels[_count]      = panel;
+  _orientation[_count] = orientation;
+  _count++;
+  return true;
+}
+
+/**
+ * @brief Advance the next panel in turn by one poll() phase
+ * @return index of the panel with a new screen tap, or -1 if there is none
+ */
+int8_t TouchPanelGroup::pollScreenTap(ScreenPoint *pScreenCoord) {
+  if (_count == 0) {
+    return -1;
+  }
+  uint8_t index = _next;
+  _next         = (_next + 1) % _count;
+  if (_panels[index]->pollScreenTap(pScreenCoord, _orientation[index])) {
+    return index;
+  }
+  return -1;
 }
 
 // ---------- begin unit test ----------
-void Resistive_Touch_Screen::unit_test() {
+int Resistive_Touch_Screen::unit_test() {
   Serial.println("----- Begin unit test: mapTouchToScreen()");
 
   char msg[128];
@@ -314,9 +1036,18 @@ void Resistive_Touch_Screen::unit_test() {
   Serial.println(msg);
   snprintf(msg, sizeof(msg), ". Resistance range min(x,y) = (%d,%d), max(x,y) = (%d,%d)", _x_min_ohms, _y_min_ohms, _x_max_ohms, _y_max_ohms);
   Serial.println(msg);
-  snprintf(msg, sizeof(msg), ". Start touch above %d, stop touch below %d", _start_touch_pressure, _stop_touch_pressure);
+  if (_rx) {
+    snprintf(msg, sizeof(msg), ". Start touch below %d ohms, stop touch above %d ohms", _start_touch_pressure, _stop_touch_pressure);
+  } else {
+    snprintf(msg, sizeof(msg), ". Start touch above %d, stop touch below %d", _start_touch_pressure, _stop_touch_pressure);
+  }
   Serial.println(msg);
 
+  // the expected values below are for the resistance range, so set aside any calibration
+  uint16_t saveMatrixOrientation = _matrixOrientation;
+  clearCalibration();
+  int failures = 0;
+
   ScreenPoint lowerLeft{0, 240, 900};              // when expected screen location is lower left (pixels)
   ScreenPoint lowerRight{320, 240, 900};           // when expected screen location is lower right
   ScreenPoint upperLeft{0, 0, 900};                // when expected screen location is upper left
@@ -331,37 +1062,77 @@ void Resistive_Touch_Screen::unit_test() {
 
   uint16_t o = 1;   // 1 = landscape
   Serial.println("Testing Screen Orientation in Landscape");
-  validateTouch(p00, lowerLeft, o);   // expected lower left
-  validateTouch(p01, lowerRight, o);
-  validateTouch(p10, upperLeft, o);
-  validateTouch(p11, upperRight, o);
-  validateTouch(pc, center, o);
+  failures += validateTouch(p00, lowerLeft, o);   // expected lower left
+  failures += validateTouch(p01, lowerRight, o);
+  failures += validateTouch(p10, upperLeft, o);
+  failures += validateTouch(p11, upperRight, o);
+  failures += validateTouch(pc, center, o);
 
   o = 3;   // 3 = flipped landscape
   Serial.println("Testing Screen Orientation in Flipped Landscape");
-  validateTouch(p00, upperRight, o);
-  validateTouch(p01, upperLeft, o);
-  validateTouch(p10, lowerRight, o);
-  validateTouch(p11, lowerLeft, o);
+  failures += validateTouch(p00, upperRight, o);
+  failures += validateTouch(p01, upperLeft, o);
+  failures += validateTouch(p10, lowerRight, o);
+  failures += validateTouch(p11, lowerLeft, o);
+  failures += validateTouch(pc, center, o);
+
+  // portrait orientations use a tall screen, so swap width and height during these tests
+  uint16_t saveWidth  = _width;
+  uint16_t saveHeight = _height;
+  setScreenSize(240, 320);
+
+  ScreenPoint portraitUpperLeft{0, 0, 900};   // when expected screen location is upper left (pixels)
+  ScreenPoint portraitUpperRight{240, 0, 900};
+  ScreenPoint portraitLowerLeft{0, 320, 900};
+  ScreenPoint portraitLowerRight{240, 320, 900};
+  ScreenPoint portraitCenter{(240 / 2), (320 / 2), 900};
+
+  o = 0;   // 0 = portrait
+  Serial.println("Testing Screen Orientation in Portrait");
+  failures += validateTouch(p00, portraitUpperLeft, o);
+  failures += validateTouch(p01, portraitLowerLeft, o);
+  failures += validateTouch(p10, portraitUpperRight, o);
+  failures += validateTouch(p11, portraitLowerRight, o);
+  failures += validateTouch(pc, portraitCenter, o);
+
+  o = 2;   // 2 = flipped portrait
+  Serial.println("Testing Screen Orientation in Flipped Portrait");
+  failures += validateTouch(p00, portraitLowerRight, o);
+  failures += validateTouch(p01, portraitUpperRight, o);
+  failures += validateTouch(p10, portraitLowerLeft, o);
+  failures += validateTouch(p11, portraitUpperLeft, o);
+  failures += validateTouch(pc, portraitCenter, o);
+
+  setScreenSize(saveWidth, saveHeight);
+
+  snprintf(msg, sizeof(msg), ". %d failures", failures);
+  Serial.println(msg);
+
+  _matrixOrientation = saveMatrixOrientation;
 
   Serial.println("End unit test");
+  return failures;
 }
 
-void Resistive_Touch_Screen::validateTouch(PressPoint p, ScreenPoint expected, uint16_t o) {
+int Resistive_Touch_Screen::validateTouch(PressPoint p, ScreenPoint expected, uint16_t o) {
   ScreenPoint actual{99, 99, 99};
   mapTouchToScreen(p, &actual, o);
+  int failures = 0;
   char msg[128];
   if (actual.x != expected.x) {
     snprintf(msg, sizeof(msg),
              "Fail: given resistance (%d,%d), expected x=%d, but got x=%d",
              p.x, p.y, expected.x, actual.x);
     Serial.println(msg);
+    failures++;
   }
   if (actual.y != expected.y) {
     snprintf(msg, sizeof(msg),
              "Fail: given resistance (%d,%d), expected y=%d, but got y=%d",
-             p.x, p.y, expected.x, actual.x);
+             p.x, p.y, expected.y, actual.y);
     Serial.println(msg);
+    failures++;
   }
+  return failures;
 }
 // ---------- end unit test ----------
@@ -17,11 +17,34 @@
     This class is related to the "Adafruit / Adafruit_TouchScreen" library.
 
     The public methods are:
-    * ctor                 - constructor that requires hardware pin assignments
+    * ctor                 - constructor that requires hardware pin assignments,
+                             or a TouchHal backend such as SimulatedTouchPanel
     * newScreenTap()       - an edge detector to deliver each touch only once
+    * poll()               - non-blocking acquisition, one ADC conversion per call
+    * pollScreenTap()      - non-blocking edge detector built on poll()
+    * setPollRate()        - adaptive polling: slow while idle, fast while touched (optional)
+    * nextTouchEvent()     - non-blocking stream of DOWN, MOVE and UP events for dragging
+    * setSmoothing()       - IIR or One-Euro smoothing of nextTouchEvent() positions (optional)
+    * sampleFromISR()      - background sampling from a timer interrupt
+    * readSample()         - drain samples collected by sampleFromISR()
     * setResistanceRange() - configure expected resistance measurements (optional)
     * setScreenSize()      - configure screen width and height (optional)
-    * unit_test()          - subroutine that verifies correct mapping for various screen orientations (optional)
+    * setCalibration()     - configure an affine touch-to-screen transform (optional)
+    * setCorrectionGrid()  - correct a nonlinear touch film with a 5x5 mesh of pixel offsets (optional)
+    * setLookupTables()    - map touches to pixels with table lookups instead of multiplies (optional)
+    * saveCalibration()    - copy the calibration into a CRC-protected blob for flash or EEPROM (optional)
+    * loadCalibration()    - restore a saved calibration blob at startup (optional)
+    * setOversampling()    - configure samples per measurement and how they are combined (optional)
+    * setTapValidation()   - configure how newScreenTap() rejects readings taken while landing or lifting (optional)
+    * setSettleMicros()    - configure settling delay after switching plates (optional)
+    * autoTuneSettling()   - measure and set the shortest settling delays for steady readings (optional)
+    * resetPinCache()      - forget cached pin states when pins are shared with another driver
+    * unit_test()          - subroutine that verifies mapping in every screen orientation; returns the number of failures (optional)
+    * dumpStats()          - print timing histograms and counters, if compiled with RTS_INSTRUMENTATION (optional)
+
+    class TouchPanelGroup services several Resistive_Touch_Screen objects round-robin:
+    * add()                - attach a panel and its screen orientation
+    * pollScreenTap()      - advance one panel by one phase, report which panel was tapped
 
     The protected methods are:
     * isTouching()       - which Adafruit did not implement
@@ -113,6 +136,11 @@
 */
 #include <Arduino.h>       // built-in
 #include <TouchScreen.h>   // https://github.com/adafruit/Adafruit_TouchScreen
+#include "Touch_Ring_Buffer.h"
+#include "Touch_Hal.h"
+#include "Touch_Filters.h"
+#include "Touch_Calibration.h"
+#include "Touch_Stats.h"
 
 /*
  * PressPoint encapsulates the X,Y, and Z/pressure measurements for a touch.
@@ -135,9 +163,27 @@ public:
   ScreenPoint(int16_t x, int16_t y, int16_t z);
 };
 
+/*
+ * TouchEvent reports one step of a continuous touch: pressed, moved or lifted.
+ */
+class TouchEvent {
+public:
+  enum Type : uint8_t {
+    NONE,
+    DOWN,   // start of a touch
+    MOVE,   // touch moved by at least the move threshold
+    UP,     // touch lifted; point is the last reported location
+  };
+  uint8_t type = NONE;
+  ScreenPoint point;   // screen coordinates and pressure
+  uint32_t ms = 0;     // timestamp from the TouchHal clock, normally millis()
+};
+
 // ========== Class Resistive_Touch_Screen ==========
 class Resistive_Touch_Screen {
 public:
+  static const uint16_t NO_CONTACT = 0x7FFF;   // pressure in ohms when nothing touches the panel, fits TSPoint::z
+
   /**
    * @brief Construct a new Resistive Touch Screen object
    *
@@ -149,11 +195,22 @@ public:
    */
   // clang-format off
   Resistive_Touch_Screen(uint8_t x_plus_pin, uint8_t y_plus_pin, uint8_t x_minus_pin, uint8_t y_minus_pin, uint16_t rx)
-    : _x_plus_pin(x_plus_pin)
-    , _y_plus_pin(y_plus_pin)
-    , _x_minus_pin(x_minus_pin)
-    , _y_minus_pin(y_minus_pin)
-    , _rx(rx) {}
+    : _arduinoHal(x_plus_pin, y_plus_pin, x_minus_pin, y_minus_pin)
+    , _hal(&_arduinoHal)
+    , _rx(rx) { setDefaultThresholds(); }
+  // clang-format on
+
+  /**
+   * @brief Construct a Resistive Touch Screen object on a custom hardware backend
+   *
+   * @param hal Pin and ADC backend, e.g. a SimulatedTouchPanel. Must outlive this object.
+   * @param rx  The resistance in ohms between X+ and X- to calibrate pressure sensing
+   */
+  // clang-format off
+  Resistive_Touch_Screen(TouchHal *hal, uint16_t rx)
+    : _arduinoHal(0, 0, 0, 0)
+    , _hal(hal)
+    , _rx(rx) { setDefaultThresholds(); }
   // clang-format on
 
   /**
@@ -161,40 +218,235 @@ public:
    * @brief If true, also return screen coordinates of the touch
    * @brief and then returns FALSE until pressure is released and screen is touched again.
    */
-  // orientation = 1 or 3 = ILI9341 screen rotation setting in landscape only
+  // orientation = 0..3 = ILI9341 screen rotation setting
   bool newScreenTap(ScreenPoint *pScreenCoord, uint16_t orientation);
 
+  /**
+   * @brief Non-blocking acquisition: advance by one phase, at most one analogRead() per call
+   * @return true when a complete touch sample has been measured, see lastSample()
+   */
+  bool poll(void);
+  PressPoint lastSample(void) const { return _sample; }
+  bool pollTouched(void) const { return _pollTouching; }   // poll() sees a touch, after hysteresis
+
+  /**
+   * @brief Adaptive polling: slow pen-down checks while idle, fast full cycles while touched
+   */
+  void setPollRate(uint16_t idle_ms, uint16_t active_ms);
+  void setPenDownThreshold(uint16_t z1_counts) { _penDownThreshold = z1_counts; }
+  uint16_t pollIntervalMs(void) const { return _intervalMs; }         // current time between cycles
+  uint16_t dutyCyclePermille(void) const { return _dutyPermille; }   // share of time spent in poll()
+
+  /**
+   * @brief Same edge detection as newScreenTap() but driven by poll(), so each call is cheap
+   */
+  bool pollScreenTap(ScreenPoint *pScreenCoord, uint16_t orientation);
+
+  /**
+   * @brief Continuous touch stream for dragging: DOWN, then MOVE as the touch travels, then UP.
+   * @brief Built on poll(), so it shares one acquisition pass; use it instead of pollScreenTap().
+   * @return true if *pEvent was filled with a new event
+   */
+  bool nextTouchEvent(TouchEvent *pEvent, uint16_t orientation);
+  void setMoveThreshold(uint8_t pixels) { _moveThreshold = pixels; }   // minimum travel for a MOVE event
+
+  /**
+   * @brief Smooth the measurements of nextTouchEvent() before mapping, see TouchSmoother.
+   * @brief mode = TouchSmoother::OFF (default), IIR or ONE_EURO; alphas in 1/256.
+   */
+  void setSmoothing(uint8_t mode, uint8_t minAlpha = TouchSmoother::DEFAULT_MIN_ALPHA, uint8_t beta = TouchSmoother::DEFAULT_BETA) {
+    _smoother.configure(mode, minAlpha, beta);
+  }
+
+  /**
+   * @brief Background sampling: call sampleFromISR() from a periodic timer interrupt
+   * @brief and drain the finished samples with readSample() in loop().
+   *
+   * The sketch owns the timer (e.g. a SAMD51 TC via Adafruit_ZeroTimer) so this
+   * library stays portable. Each interrupt performs one poll() phase. While the
+   * sampler is running, do not call the blocking methods or poll() from loop().
+   */
+  void sampleFromISR(void) {
+    if (poll()) {
+      _samples.push(_sample);
+    }
+  }
+  bool readSample(PressPoint *pTouchOhms) { return _samples.pop(pTouchOhms); }
+  uint16_t droppedSamples(void) const { return _samples.dropped(); }
+
   // getters and setters
   void setResistanceRange(uint16_t x_min, uint16_t x_max, uint16_t y_min, uint16_t y_max, uint16_t xp_xm) {
-    _x_min_ohms = x_min;
-    _x_max_ohms = x_max;
-    _y_min_ohms = y_min;
-    _y_max_ohms = y_max;
-    _rx         = xp_xm;   // typ. 310 ohms
+    bool newUnits     = (xp_xm != 0) != (_rx != 0);
+    _x_min_ohms       = x_min;
+    _x_max_ohms       = x_max;
+    _y_min_ohms       = y_min;
+    _y_max_ohms       = y_max;
+    _rx               = xp_xm;   // typ. 310 ohms
+    rebuildTransform();
+    if (newUnits) {
+      setDefaultThresholds();   // pressure changed between ADC counts and ohms
+    }
   }
   void setScreenSize(uint16_t x_max, uint16_t y_max) {
     _width  = x_max;
     _height = y_max;
+    rebuildTransform();
+    setCorrectionGrid(_grid, _gridOrientation);
+  }
+  /**
+   * @brief Affine calibration, used by mapTouchToScreen() in place of the resistance range
+   * @brief whenever the screen is in the orientation the calibration was made for.
+   *
+   * @param touch  = resistance measurements at known screen locations
+   * @param screen = the known screen locations, in pixels
+   * @param count  = number of points, at least 3 (more points give a least-squares fit)
+   * @return false if the points cannot be fitted; the previous calibration is kept
+   */
+  bool setCalibration(const PressPoint touch[], const ScreenPoint screen[], uint8_t count, uint16_t orientation) {
+    TouchMatrix m;
+    if (!m.solve(touch, screen, count)) {
+      return false;
+    }
+    setCalibration(m, orientation);
+    return true;
   }
+  void setCalibration(const TouchMatrix &m, uint16_t orientation) {
+    _matrix            = m;
+    _matrixOrientation = orientation;
+  }
+  void clearCalibration(void) { _matrixOrientation = NO_ORIENTATION; }
+  const TouchMatrix &getCalibration(void) const { return _matrix; }
+
+  /**
+   * @brief Optional lookup tables that replace the multiplies of the resistance-range mapping.
+   * @brief Buffers of entries + 1 int16_t each; 1024 entries use 4 KB in total, 256 use 1 KB.
+   */
+  bool setLookupTables(int16_t *x_table, int16_t *y_table, uint16_t entries);
+
+  /**
+   * @brief Nonlinearity correction, added to the result of the affine or range mapping.
+   * @param grid = pixel offsets over the screen; not copied, so it must outlive this object.
+   *               nullptr turns correction off.
+   * @param orientation = screen rotation the grid was measured in
+   */
+  void setCorrectionGrid(const TouchCorrectionGrid *grid, uint16_t orientation) {
+    _grid            = grid;
+    _gridOrientation = orientation;
+    _gridScaleX      = TouchCorrectionGrid::scaleFor(_width, TouchCorrectionGrid::COLS - 1);
+    _gridScaleY      = TouchCorrectionGrid::scaleFor(_height, TouchCorrectionGrid::ROWS - 1);
+  }
+
+  /**
+   * @brief Save or restore the whole calibration: resistance range, rx, thresholds and matrix.
+   * @brief loadCalibration() copies a saved blob, checks its CRC and applies it, so startup
+   * @brief can skip calibrating when flash or EEPROM already holds a valid record.
+   */
+  void getCalibrationRecord(TouchCalibrationRecord *rec) const;
+  bool setCalibrationRecord(const TouchCalibrationRecord &rec);   // false if rec is not valid
+  size_t saveCalibration(uint8_t *blob, size_t size) const;       // bytes written, 0 if size is too small
+  bool loadCalibration(const uint8_t *blob, size_t size);         // false if blob is not a valid record
+
+  /**
+   * @brief Hysteresis thresholds for the start and end of a touch.
+   * @brief With rx = 0, pressure is in ADC counts: a touch starts above start_ohms and ends below stop_ohms.
+   * @brief With rx in ohms, pressure is the touch resistance in ohms, which falls as the touch gets firmer:
+   * @brief a touch starts below start_ohms and ends above stop_ohms.
+   */
   void setThreshhold(uint16_t start_ohms, uint16_t stop_ohms) {
     _start_touch_pressure = start_ohms;
     _stop_touch_pressure  = stop_ohms;
   }
-  void unit_test();
+  int unit_test();   // returns the number of failures, each of which is also printed
+
+  // instrumentation, when compiled with RTS_INSTRUMENTATION (see Touch_Stats.h)
+  void dumpStats(Print &out);
+  void resetStats(void);
+
+  /**
+   * @brief Pin state cache: only real changes of pin mode or level reach the hardware.
+   * @brief Call resetPinCache() if another driver (e.g. the TFT) shares and changes these pins.
+   */
+  void resetPinCache(void);
+  uint32_t pinTransitionsExecuted(void) const { return _pinExecuted; }
+  uint32_t pinTransitionsSkipped(void) const { return _pinSkipped; }
 
   TSPoint getPoint();
 
+  /**
+   * @brief Delay between switching the plates and converting, per phase (default 0 us).
+   * @brief autoTuneSettling() picks the shortest delays that give steady readings while touched.
+   */
+  void setSettleMicros(uint16_t x_us, uint16_t y_us, uint16_t z_us) {
+    _settleUs[SETTLE_X] = x_us;
+    _settleUs[SETTLE_Y] = y_us;
+    _settleUs[SETTLE_Z] = z_us;
+  }
+  void getSettleMicros(uint16_t *x_us, uint16_t *y_us, uint16_t *z_us) const {
+    *x_us = _settleUs[SETTLE_X];
+    *y_us = _settleUs[SETTLE_Y];
+    *z_us = _settleUs[SETTLE_Z];
+  }
+  bool autoTuneSettling(uint16_t variance_target, uint16_t max_us = 200);
+  void setOversampling(uint8_t xy_samples, uint8_t z_samples, uint8_t reducer = TouchFilter::MEDIAN);
+
+  /**
+   * @brief newScreenTap() measures X and Y twice between pressure checks, and reports
+   * @brief the tap only if pressure held and the two measurements agree (default 20 counts, 3 retries).
+   * @param tolerance = largest difference in X or Y between the measurements, 0 turns validation off
+   * @param retries   = extra attempts before giving up until the next call
+   */
+  void setTapValidation(uint16_t tolerance, uint8_t retries) {
+    _tapTolerance = tolerance;
+    _tapRetries   = retries;
+  }
+
 protected:
-  uint16_t pressure(void);
+  uint16_t pressure(void);                            // reads X too if pressure is in ohms
+  uint16_t pressureAt(int x);                         // pressure where X is already known
   bool isTouching(void);
   void mapTouchToScreen(PressPoint touchOhms, ScreenPoint *screenCoord, int orientation);
   int readTouchX(void);
   int readTouchY(void);
-  void insert_sort(uint16_t array[], uint8_t size);
-  void validateTouch(PressPoint p, ScreenPoint expected, uint16_t o);   // for unit tests
+  int sampleX(void);                                  // oversampled readTouchX()
+  int sampleY(void);                                  // oversampled readTouchY()
+  uint16_t samplePressure(int x);                     // oversampled pressureAt()
+  bool sampleValidated(PressPoint *touchOhms);        // X,Y,Z of a new tap, see setTapValidation()
+  void setPlateMode(uint8_t plate, uint8_t mode);     // cached pinMode()
+  void setPlateLevel(uint8_t plate, uint8_t level);   // cached digitalWrite()
+  void driveX(void);                                  // configure plates for an X measurement
+  void driveY(void);                                  // configure plates for a Y measurement
+  void drivePressure(void);                           // configure plates for Z1,Z2 measurements
+  bool drivePlates(uint8_t phase);                    // whole phase through TouchHal::drivePhase()
+  void settle(uint8_t phase, uint32_t before);        // wait after a drive phase, if pins changed
+  int convert(uint8_t plate);                         // one analog conversion
+  uint16_t reduce(uint16_t v[], uint8_t n);           // combine oversampled values
+  uint16_t computePressure(int z1, int z2, int x);
+  void setDefaultThresholds(void);
+
+  // compare a pressure with a threshold; in ohms, a lower touch resistance is a firmer touch
+  bool firmerThan(uint16_t pres_val, uint16_t threshold) const { return _rx ? (pres_val < threshold) : (pres_val > threshold); }
+  bool lighterThan(uint16_t pres_val, uint16_t threshold) const { return _rx ? (pres_val > threshold) : (pres_val < threshold); }
+  bool applyHysteresis(bool touching, uint16_t pres_val);
+  bool pollPhase(void);
+  void pollDecide(uint16_t pres_val);
+  void buildTransform(int orientation);
+  void rebuildTransform(void);   // now, for the orientation last used, instead of on the next touch
+  int16_t lookup(const int16_t *table, int16_t touch) const;
+  int validateTouch(PressPoint p, ScreenPoint expected, uint16_t o);   // for unit tests
 
 private:
-  uint8_t _x_plus_pin, _y_plus_pin, _x_minus_pin, _y_minus_pin, _rx;
+  ArduinoTouchHal _arduinoHal;   // default backend, on the pins given to the ctor
+  TouchHal *_hal;                // backend used for all pin and ADC operations
+  uint16_t _rx;                  // resistance in ohms between X+ and X-
+
+  // shadow copy of each plate's pin mode and level, see setPlateMode()
+  static const uint8_t PIN_UNKNOWN = 0xFF;
+  uint8_t _plateMode[TouchHal::NUM_PLATES]  = {PIN_UNKNOWN, PIN_UNKNOWN, PIN_UNKNOWN, PIN_UNKNOWN};
+  uint8_t _plateLevel[TouchHal::NUM_PLATES] = {PIN_UNKNOWN, PIN_UNKNOWN, PIN_UNKNOWN, PIN_UNKNOWN};
+  uint32_t _pinExecuted = 0;                      // pin changes sent to the hardware
+  uint32_t _pinSkipped  = 0;                      // pin changes avoided by the cache
+  bool _halDrivesPhases = true;                   // until TouchHal::drivePhase() says otherwise, see drivePlates()
+  uint8_t _drivenPhase  = TouchHal::NUM_PHASES;   // phase the plates are in, if drivePlates() put them there
 
   uint16_t _width  = 320;   // Default: screen pixels
   uint16_t _height = 240;
@@ -204,6 +456,101 @@ private:
   uint16_t _y_min_ohms = 100;   // Default: Expected range on touchscreen's Y-axis readings
   uint16_t _y_max_ohms = 900;
 
-  uint16_t _start_touch_pressure = 200;   // minimum threshold to detect start of touch
-  uint16_t _stop_touch_pressure  = 50;    // maximum threshold to detect end of touch
+  uint16_t _start_touch_pressure = 200;   // threshold to detect start of touch, see setThreshhold()
+  uint16_t _stop_touch_pressure  = 50;    // threshold to detect end of touch
+
+  bool _buttonState = false;   // hysteresis state of isTouching()
+  bool _tapTouching = false;   // newScreenTap() already reported this touch
+
+  uint16_t _tapTolerance = 20;   // see setTapValidation()
+  uint8_t _tapRetries    = 3;
+
+  static const uint16_t NO_ORIENTATION = 0xFFFF;
+  TouchMatrix _matrix;                            // affine calibration, see setCalibration()
+  uint16_t _matrixOrientation = NO_ORIENTATION;   // screen rotation that _matrix applies to
+  TouchMatrix _xform;                             // derived from resistance range, see buildTransform()
+  uint16_t _xformOrientation = NO_ORIENTATION;    // screen rotation that _xform was built for
+
+  static const uint8_t LUT_FRACTION_BITS = 4;   // table entries are in 1/16 pixels
+  int16_t *_lutX         = nullptr;             // see setLookupTables()
+  int16_t *_lutY         = nullptr;
+  uint8_t _lutShift      = 0;                   // log2 of touch measurements per table entry
+  bool _lutFromY[2]      = {false, false};      // screen x and y are looked up by touch Y
+
+  const TouchCorrectionGrid *_grid = nullptr;          // see setCorrectionGrid()
+  uint16_t _gridOrientation        = NO_ORIENTATION;   // screen rotation that _grid applies to
+  uint32_t _gridScaleX             = 0;                // Q16 grid cells per pixel
+  uint32_t _gridScaleY             = 0;
+
+  enum SettlePhase : uint8_t {
+    SETTLE_X,
+    SETTLE_Y,
+    SETTLE_Z,
+    NUM_SETTLE,
+  };
+  uint16_t _settleUs[NUM_SETTLE] = {0, 0, 0};   // settling delay of each drive phase, see settle()
+
+  uint8_t _xySamples = 1;                     // samples per X and Y measurement
+  uint8_t _zSamples  = 3;                     // samples per Z measurement
+  uint8_t _reducer   = TouchFilter::MEDIAN;   // how samples are combined
+
+  // state of the non-blocking acquisition engine, see poll()
+  enum AcquirePhase : uint8_t {
+    PHASE_Z1,   // drive plates for pressure, convert Z1
+    PHASE_Z2,   // convert Z2 and, for pressure in ADC counts, decide whether the screen is touched
+    PHASE_X,    // drive and convert X and, for pressure in ohms, decide whether the screen is touched
+    PHASE_Y,    // drive and convert Y, sample is complete
+  };
+  AcquirePhase _phase = PHASE_Z1;
+  int _z1             = 0;
+  int _z2             = 0;
+  uint8_t _count      = 0;   // oversamples collected in the current phase
+  uint16_t _oversample[TouchFilter::MAX_SAMPLES];
+  PressPoint _sample;   // most recent complete measurement
+
+  bool _pollTouching    = false;   // hysteresis state of poll()
+  bool _pollTapReported = false;   // pollScreenTap() already reported this touch
+
+  // adaptive schedule of poll(), see setPollRate()
+  uint16_t _idleMs           = 0;   // 0 = adaptive polling is off
+  uint16_t _activeMs         = 0;
+  uint16_t _intervalMs       = 0;   // current time between measurement cycles
+  uint16_t _penDownThreshold = 8;   // Z1 counts that suggest something touches the panel
+  uint32_t _cycleStartUs     = 0;
+  uint32_t _busyUs           = 0;   // time spent in poll() during this window
+  uint32_t _windowStartUs    = 0;
+  uint16_t _dutyPermille     = 0;   // result of the last complete window
+  bool _pollReleased    = false;   // poll() saw the touch end, not yet handled by nextTouchEvent()
+
+  bool _streamDown       = false;   // nextTouchEvent() reported DOWN but not yet UP
+  ScreenPoint _streamLast;          // location of the last DOWN or MOVE event
+  uint8_t _moveThreshold = 2;       // pixels
+  TouchSmoother _smoother;          // see setSmoothing()
+
+  TouchRingBuffer<PressPoint, 8> _samples;   // filled by sampleFromISR(), drained by readSample()
+
+#if RTS_INSTRUMENTATION
+  TouchStats _stats;
+#endif
+};
+
+// ========== Class TouchPanelGroup ==========
+/*
+ * Services several touch screens from a single call in loop().
+ * Each call advances only one panel by one poll() phase, taking turns,
+ * so the time per call stays bounded however many panels are attached.
+ */
+class TouchPanelGroup {
+public:
+  static const uint8_t MAX_PANELS = 4;
+
+  bool add(Resistive_Touch_Screen *panel, uint16_t orientation);
+  int8_t pollScreenTap(ScreenPoint *pScreenCoord);   // index of tapped panel, or -1
+  uint8_t count(void) const { return _count; }
+
+private:
+  Resistive_Touch_Screen *_panels[MAX_PANELS];
+  uint16_t _orientation[MAX_PANELS];
+  uint8_t _count = 0;
+  uint8_t _next  = 0;   // panel to service on the next call
 };
@@ -0,0 +1,85 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Calibration.cpp
+
+  Purpose:  Affine calibration from touchscreen measurements to screen pixels.
+            See Touch_Calibration.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Calibration.h"
+
+/*
+ * Solve the 3x3 normal equations of a least-squares fit with Cramer's rule.
+ * This only runs while calibrating, so floating point is acceptable here.
+ * Coordinates are taken relative to their mean to keep the sums well conditioned.
+ */
+bool TouchMatrix::solve(const TSPoint touch[], const TSPoint screen[], uint8_t count) {
+  if (count < 3) {
+    return false;
+  }
+
+  double mx = 0, my = 0;   // mean touch position
+  for (uint8_t ii = 0; ii < count; ii++) {
+    mx += touch[ii].x;
+    my += touch[ii].y;
+  }
+  mx /= count;
+  my /= count;
+
+  double sxx = 0, sxy = 0, syy = 0;   // second moments of touch positions
+  double sxu = 0, syu = 0, su = 0;    // moments against screen x
+  double sxv = 0, syv = 0, sv = 0;    // moments against screen y
+  for (uint8_t ii = 0; ii < count; ii++) {
+    double x = touch[ii].x - mx;
+    double y = touch[ii].y - my;
+    sxx += x * x;
+    sxy += x * y;
+    syy += y * y;
+    sxu += x * screen[ii].x;
+    syu += y * screen[ii].x;
+    su += screen[ii].x;
+    sxv += x * screen[ii].y;
+    syv += y * screen[ii].y;
+    sv += screen[ii].y;
+  }
+
+  // with centered coordinates the normal equations decouple into a 2x2 system plus the mean
+  double det = sxx * syy - sxy * sxy;
+  if (det < 1e-6 * (sxx * syy + 1)) {
+    return false;   // points are in a line
+  }
+  double ra = (sxu * syy - syu * sxy) / det;
+  double rb = (syu * sxx - sxu * sxy) / det;
+  double rc = su / count - ra * mx - rb * my;
+  double rd = (sxv * syy - syv * sxy) / det;
+  double re = (syv * sxx - sxv * sxy) / det;
+  double rf = sv / count - rd * mx - re * my;
+
+  const double scale = (double)((int32_t)1 << FRACTION_BITS);
+  a                  = (int32_t)lround(ra * scale);
+  b                  = (int32_t)lround(rb * scale);
+  c                  = (int32_t)lround(rc * scale);
+  d                  = (int32_t)lround(rd * scale);
+  e                  = (int32_t)lround(re * scale);
+  f                  = (int32_t)lround(rf * scale);
+  return true;
+}
+
+/*
+ * CRC-32 (IEEE 802.3) computed bit by bit, since the record is small and only
+ * checked at startup; a lookup table would cost 1 KB of flash.
+ */
+uint32_t TouchCalibrationRecord::computeCrc(void) const {
+  const uint8_t *p = (const uint8_t *)this;
+  size_t n         = offsetof(TouchCalibrationRecord, crc);
+  uint32_t crc32   = 0xFFFFFFFF;
+  while (n--) {
+    crc32 ^= *p++;
+    for (int bit = 0; bit < 8; bit++) {
+      crc32 = (crc32 >> 1) ^ (0xEDB88320 & -(crc32 & 1));
+    }
+  }
+  return ~crc32;
+}
@@ -0,0 +1,151 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Calibration.h
+
+  Purpose:  Affine calibration from touchscreen measurements to screen pixels.
+
+            Independent map() calls per axis can only stretch and shift each axis.
+            An affine transform also corrects a panel that is slightly rotated or
+            skewed relative to the TFT, and is applied with multiplies and shifts,
+            no division, which is cheap on processors without a fast divider.
+
+            TouchCorrectionGrid fixes the nonlinearity of cheap films, which no affine
+            transform can, by adding small pixel offsets interpolated from a 5x5 mesh.
+
+            TouchCalibrationRecord holds a complete calibration in a fixed binary
+            layout, so it can be saved to flash or EEPROM and used again at startup.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>       // built-in
+#include <TouchScreen.h>   // https://github.com/adafruit/Adafruit_TouchScreen
+
+/*
+ * TouchMatrix is a 2x3 affine transform in fixed point with 16 fractional bits:
+ *   screen.x = (a * touch.x + b * touch.y + c) / 65536
+ *   screen.y = (d * touch.x + e * touch.y + f) / 65536
+ */
+class TouchMatrix {
+public:
+  static const uint8_t FRACTION_BITS = 16;
+
+  int32_t a = 0, b = 0, c = 0;
+  int32_t d = 0, e = 0, f = 0;
+
+  // convert touch measurements into screen coordinates, rounded to the nearest pixel
+  void apply(const TSPoint &touch, TSPoint *screen) const {
+    const int64_t half = (int64_t)1 << (FRACTION_BITS - 1);
+    screen->x          = (int16_t)(((int64_t)a * touch.x + (int64_t)b * touch.y + c + half) >> FRACTION_BITS);
+    screen->y          = (int16_t)(((int64_t)d * touch.x + (int64_t)e * touch.y + f + half) >> FRACTION_BITS);
+  }
+
+  /**
+   * @brief Least-squares fit of the matrix to pairs of touch measurements and screen locations
+   *
+   * @param touch  = resistance measurements
+   * @param screen = where each of those touches was on the screen, in pixels
+   * @param count  = number of pairs, at least 3 and not all in a line
+   * @return false if the points do not determine a transform; the matrix is unchanged
+   */
+  bool solve(const TSPoint touch[], const TSPoint screen[], uint8_t count);
+};
+
+/*
+ * Pixel offsets at 5x5 control points spread evenly over the screen, from (0,0) to
+ * (width,height), added to the affine result with bilinear interpolation.
+ * Offsets are stored in quarter pixels, so each can correct up to +/-31 pixels,
+ * and the whole grid takes 50 bytes. It is plain data, so it can live in flash.
+ */
+class TouchCorrectionGrid {
+public:
+  static const uint8_t COLS          = 5;
+  static const uint8_t ROWS          = 5;
+  static const uint8_t FRACTION_BITS = 2;   // offsets are in 1/4 pixels
+
+  int8_t dx[ROWS][COLS] = {};
+  int8_t dy[ROWS][COLS] = {};
+
+  // offset at one control point, in pixels; rounded to 1/4 pixel and clamped to the range of int8_t
+  void setOffset(uint8_t col, uint8_t row, float dx_pixels, float dy_pixels) {
+    dx[row][col] = quantize(dx_pixels);
+    dy[row][col] = quantize(dy_pixels);
+  }
+
+  /**
+   * @brief Add the interpolated offset to a screen location
+   *
+   * The position within the grid is found with a multiply by a Q16 reciprocal of the
+   * cell size instead of a division. Interpolation weights are 8-bit fractions.
+   *
+   * @param x_scale = ((COLS - 1) << 16) / width, see scaleFor()
+   * @param y_scale = ((ROWS - 1) << 16) / height
+   */
+  void apply(TSPoint *screen, uint32_t x_scale, uint32_t y_scale) const {
+    uint32_t u  = (uint32_t)constrain(screen->x, 0, 0x7FFF) * x_scale;   // grid column, Q16
+    uint32_t v  = (uint32_t)constrain(screen->y, 0, 0x7FFF) * y_scale;
+    uint8_t col = u >> 16;
+    uint8_t row = v >> 16;
+    int32_t fx  = (u >> 8) & 0xFF;   // position within the cell, 0..255
+    int32_t fy  = (v >> 8) & 0xFF;
+    if (col >= COLS - 1) {
+      col = COLS - 2;   // right edge, or beyond the screen
+      fx  = 256;
+    }
+    if (row >= ROWS - 1) {
+      row = ROWS - 2;
+      fy  = 256;
+    }
+    screen->x += interpolate(dx, col, row, fx, fy);
+    screen->y += interpolate(dy, col, row, fx, fy);
+  }
+
+  static uint32_t scaleFor(uint16_t pixels, uint8_t cells) { return pixels ? ((uint32_t)cells << 16) / pixels : 0; }
+
+protected:
+  static int8_t quantize(float pixels) {
+    float q = pixels * (1 << FRACTION_BITS);
+    return (int8_t)constrain((int)(q < 0 ? q - 0.5f : q + 0.5f), -127, 127);
+  }
+  static int16_t interpolate(const int8_t g[ROWS][COLS], uint8_t col, uint8_t row, int32_t fx, int32_t fy) {
+    int32_t top    = g[row][col] * (256 - fx) + g[row][col + 1] * fx;
+    int32_t bottom = g[row + 1][col] * (256 - fx) + g[row + 1][col + 1] * fx;
+    int32_t sum    = top * (256 - fy) + bottom * fy;   // Q16, in 1/4 pixels
+
+    const uint8_t shift = 16 + FRACTION_BITS;
+    return (int16_t)((sum + ((int32_t)1 << (shift - 1))) >> shift);
+  }
+};
+
+/*
+ * Everything needed to restore a calibrated touchscreen, as one fixed-size block.
+ * Fields are naturally aligned, so the record is its own wire format: loading it
+ * is a memcpy and a CRC check, with no parsing. Multi-byte fields are stored in
+ * the byte order of the board that saved them.
+ */
+struct TouchCalibrationRecord {
+  static const uint32_t MAGIC   = 0x43535452;   // "RTSC" in memory on little-endian boards
+  static const uint16_t VERSION = 1;
+
+  uint32_t magic   = MAGIC;
+  uint16_t version = VERSION;
+  uint16_t size    = sizeof(TouchCalibrationRecord);
+
+  uint16_t x_min           = 0;        // see setResistanceRange()
+  uint16_t x_max           = 0;
+  uint16_t y_min           = 0;
+  uint16_t y_max           = 0;
+  uint16_t rx              = 0;
+  uint16_t start_threshold = 0;        // see setThreshhold()
+  uint16_t stop_threshold  = 0;
+  uint16_t orientation     = 0xFFFF;   // screen rotation the matrix applies to, 0xFFFF if none
+  int32_t matrix[6]        = {0};      // TouchMatrix a..f
+
+  uint32_t crc = 0;   // CRC-32 of all the bytes above
+
+  void seal(void) { crc = computeCrc(); }   // call after changing any field
+  bool isValid(void) const {
+    return magic == MAGIC && version == VERSION && size == sizeof(TouchCalibrationRecord) && crc == computeCrc();
+  }
+  uint32_t computeCrc(void) const;
+};
+static_assert(sizeof(TouchCalibrationRecord) == 52, "calibration record must not contain padding");
@@ -0,0 +1,183 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Calibrator.cpp
+
+  Purpose:  On-device calibration workflow, see Touch_Calibrator.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Calibrator.h"
+
+/**
+ * @brief Use caller-chosen targets instead of the default five
+ * @param targets = screen locations in pixels, copied; at most MAX_TARGETS are used
+ * @return false, keeping the previous targets, if there are too few to fit a matrix
+ */
+bool TouchCalibrator::setTargets(const ScreenPoint targets[], uint8_t count) {
+  if (targets == nullptr || count < MIN_TARGETS) {
+    return false;
+  }
+  _numTargets = (count < MAX_TARGETS) ? count : MAX_TARGETS;
+  for (uint8_t ii = 0; ii < _numTargets; ii++) {
+    _targets[ii] = targets[ii];
+  }
+  _customTargets = true;
+  return true;
+}
+
+/**
+ * @brief Start over with the first target
+ * @param width, height = screen size in pixels, in the orientation being calibrated
+ * @param orientation   = screen rotation the resulting matrix applies to
+ */
+void TouchCalibrator::begin(uint16_t width, uint16_t height, uint16_t orientation) {
+  _width       = width;
+  _height      = height;
+  _orientation = orientation;
+  if (!_customTargets) {
+    // inset 10% from each edge, where the panel is still linear, plus the center
+    int16_t left   = width / 10;
+    int16_t right  = width - width / 10;
+    int16_t top    = height / 10;
+    int16_t bottom = height - height / 10;
+    _targets[0]    = ScreenPoint(left, top, 0);
+    _targets[1]    = ScreenPoint(right, top, 0);
+    _targets[2]    = ScreenPoint(right, bottom, 0);
+    _targets[3]    = ScreenPoint(left, bottom, 0);
+    _targets[4]    = ScreenPoint(width / 2, height / 2, 0);
+    _numTargets    = 5;
+  }
+  _target  = 0;
+  _count   = 0;
+  _skipped = 0;
+  _state   = COLLECTING;
+  prompt();
+}
+
+/**
+ * @brief Advance the workflow by one poll() of the touchscreen
+ * @return true once, when the last target has been collected and the fit succeeded
+ */
+bool TouchCalibrator::update(void) {
+  if (_state != COLLECTING) {
+    return false;
+  }
+
+  if (_screen.poll() && _count < TouchFilter::MAX_SAMPLES) {
+    if (_skipped < SKIP_SAMPLES) {
+      _skipped++;   // still landing
+    } else {
+      PressPoint p = _screen.lastSample();
+      _xs[_count]  = p.x;
+      _ys[_count]  = p.y;
+      _count++;
+    }
+  }
+
+  if (!_screen.pollTouched() && (_skipped > 0)) {
+    // lifted: accept the target if the touch was held long enough, otherwise ask again
+    if (_count >= MIN_SAMPLES) {
+      acceptTarget();
+    }
+    _count   = 0;
+    _skipped = 0;
+  }
+  return _state == DONE;
+}
+
+void TouchCalibrator::prompt(void) {
+  if (_prompt) {
+    _prompt(_target, _targets[_target], _context);
+  }
+}
+
+/**
+ * @brief Combine the samples of one target, with a trimmed mean to reject outliers
+ */
+void TouchCalibrator::acceptTarget(void) {
+  uint8_t n         = (_count & 1) ? _count : _count - 1;   // filters take an odd count
+  _touches[_target] = PressPoint(TouchFilter::reduce(_xs, n, TouchFilter::TRIMMED_MEAN),
+                                 TouchFilter::reduce(_ys, n, TouchFilter::TRIMMED_MEAN), 0);
+  _target++;
+  if (_target < _numTargets) {
+    prompt();
+  } else {
+    finish();
+  }
+}
+
+/**
+ * @brief Fit the matrix, derive resistance ranges and measure the residual error
+ */
+void TouchCalibrator::finish(void) {
+  TouchMatrix inverse;   // screen pixels to touch measurements
+  if (!_matrix.solve(_touches, _targets, _numTargets) || !inverse.solve(_targets, _touches, _numTargets)) {
+    _state = FAILED;
+    return;
+  }
+
+  // Ranges for the other orientations: where the screen corners are on the panel.
+  // Each touch axis runs along one pair of screen edges; the two corners at each
+  // end of that axis are averaged to take out any skew.
+  const ScreenPoint corners[4] = {{0, 0, 0}, {(int16_t)_width, 0, 0}, {0, (int16_t)_height, 0}, {(int16_t)_width, (int16_t)_height, 0}};
+  uint16_t xs[4], ys[4];
+  for (int ii = 0; ii < 4; ii++) {
+    PressPoint p;
+    inverse.apply(corners[ii], &p);
+    xs[ii] = constrain(p.x, 0, 1023);
+    ys[ii] = constrain(p.y, 0, 1023);
+  }
+  // sort each set of four with a 5-comparator network
+  const uint8_t network[5][2] = {{0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}};
+  for (int ii = 0; ii < 5; ii++) {
+    TouchFilter::cswap(xs[network[ii][0]], xs[network[ii][1]]);
+    TouchFilter::cswap(ys[network[ii][0]], ys[network[ii][1]]);
+  }
+  _x_min = (xs[0] + xs[1] + 1) / 2;
+  _x_max = (xs[2] + xs[3] + 1) / 2;
+  _y_min = (ys[0] + ys[1] + 1) / 2;
+  _y_max = (ys[2] + ys[3] + 1) / 2;
+
+  // residual error of the fit, in fractional pixels
+  const float scale = 1.0f / (1L << TouchMatrix::FRACTION_BITS);
+  float sumSquares  = 0;
+  _maxError         = 0;
+  for (uint8_t ii = 0; ii < _numTargets; ii++) {
+    const PressPoint &t = _touches[ii];
+    float sx            = ((float)_matrix.a * t.x + (float)_matrix.b * t.y + _matrix.c) * scale;
+    float sy            = ((float)_matrix.d * t.x + (float)_matrix.e * t.y + _matrix.f) * scale;
+    float dx            = sx - _targets[ii].x;
+    float dy            = sy - _targets[ii].y;
+    float error2        = dx * dx + dy * dy;
+    sumSquares += error2;
+    if (sqrtf(error2) > _maxError) {
+      _maxError = sqrtf(error2);
+    }
+  }
+  _rmsError = sqrtf(sumSquares / _numTargets);
+  _state    = DONE;
+}
+
+/**
+ * @brief Build a calibration record from the screen's current settings and the fitted result
+ */
+bool TouchCalibrator::getRecord(TouchCalibrationRecord *rec) const {
+  if (_state != DONE) {
+    return false;
+  }
+  _screen.getCalibrationRecord(rec);   // keeps rx and the touch thresholds
+  rec->x_min       = _x_min;
+  rec->x_max       = _x_max;
+  rec->y_min       = _y_min;
+  rec->y_max       = _y_max;
+  rec->orientation = _orientation;
+  rec->matrix[0]   = _matrix.a;
+  rec->matrix[1]   = _matrix.b;
+  rec->matrix[2]   = _matrix.c;
+  rec->matrix[3]   = _matrix.d;
+  rec->matrix[4]   = _matrix.e;
+  rec->matrix[5]   = _matrix.f;
+  rec->seal();
+  return true;
+}
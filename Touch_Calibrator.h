@@ -0,0 +1,98 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Calibrator.h
+
+  Purpose:  Calibrate a touchscreen on the device, without editing #defines.
+
+            TouchCalibrator asks the operator to touch a series of targets, through
+            a callback that draws each one on the display. At every target it collects
+            several samples while the touch is held, skips the first few taken while
+            the stylus lands, and combines the rest with a trimmed mean. When all the
+            targets are done it fits an affine matrix, derives resistance ranges from
+            it, and reports how far the fitted matrix misses each target in pixels.
+
+            The result is a TouchCalibrationRecord that can be applied with
+            setCalibrationRecord() and stored with saveCalibration().
+
+  Usage:    void drawTarget(uint8_t index, ScreenPoint target, void *context) {
+              tft.fillScreen(ILI9341_BLACK);
+              tft.drawCircle(target.x, target.y, 8, ILI9341_WHITE);
+            }
+            TouchCalibrator calibrator(tsn, drawTarget);
+
+            calibrator.begin(tft.width(), tft.height(), tft.getRotation());
+            while (!calibrator.update()) {
+              // wait, or do other work
+            }
+            TouchCalibrationRecord rec;
+            calibrator.getRecord(&rec);
+            tsn.setCalibrationRecord(rec);
+
+  License:  GNU General Public License v3.0
+*/
+#include "Resistive_Touch_Screen.h"
+
+class TouchCalibrator {
+public:
+  static const uint8_t MAX_TARGETS  = 9;
+  static const uint8_t MIN_TARGETS  = 3;   // fewest that determine an affine matrix
+  static const uint8_t SKIP_SAMPLES = 2;   // samples ignored while the stylus lands
+  static const uint8_t MIN_SAMPLES  = 5;   // a shorter touch is ignored and the target asked again
+
+  // called to show each target, in screen pixels of the orientation given to begin()
+  typedef void (*PromptCallback)(uint8_t index, ScreenPoint target, void *context);
+
+  TouchCalibrator(Resistive_Touch_Screen &screen, PromptCallback prompt, void *context = nullptr)
+      : _screen(screen), _prompt(prompt), _context(context) {}
+
+  // optional; the default is five targets, near each corner and at the center
+  bool setTargets(const ScreenPoint targets[], uint8_t count);   // false if fewer than MIN_TARGETS
+
+  void begin(uint16_t width, uint16_t height, uint16_t orientation);   // prompts the first target
+  bool update(void);                                                    // call often; true once all targets are done
+
+  enum State : uint8_t {
+    IDLE,         // begin() not called yet
+    COLLECTING,   // waiting for touches
+    DONE,         // calibration is ready, see getRecord()
+    FAILED,       // the touches did not determine a matrix; call begin() to try again
+  };
+  State state(void) const { return _state; }
+  uint8_t targetIndex(void) const { return _target; }   // target being collected
+
+  // how far the fitted matrix misses the targets, in pixels, once DONE
+  float rmsErrorPixels(void) const { return _rmsError; }
+  float maxErrorPixels(void) const { return _maxError; }
+
+  const TouchMatrix &getMatrix(void) const { return _matrix; }
+  bool getRecord(TouchCalibrationRecord *rec) const;   // false unless DONE
+
+protected:
+  void prompt(void);
+  void acceptTarget(void);
+  void finish(void);
+
+  Resistive_Touch_Screen &_screen;
+  PromptCallback _prompt;
+  void *_context;
+
+  ScreenPoint _targets[MAX_TARGETS];
+  PressPoint _touches[MAX_TARGETS];   // combined measurement at each target
+  uint8_t _numTargets   = 0;
+  bool _customTargets   = false;      // setTargets() was called
+  uint16_t _width       = 0;
+  uint16_t _height      = 0;
+  uint16_t _orientation = 0;
+  State _state          = IDLE;
+  uint8_t _target       = 0;
+
+  uint16_t _xs[TouchFilter::MAX_SAMPLES];   // samples of the current touch
+  uint16_t _ys[TouchFilter::MAX_SAMPLES];
+  uint8_t _count   = 0;
+  uint8_t _skipped = 0;
+
+  TouchMatrix _matrix;
+  uint16_t _x_min = 0, _x_max = 0, _y_min = 0, _y_max = 0;
+  float _rmsError = 0;
+  float _maxError = 0;
+};
@@ -0,0 +1,259 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Filters.h
+
+  Purpose:  Reduce N oversampled touchscreen measurements to a single value.
+
+            Sorting uses fixed sorting networks for N = 3, 5, 7 and 9, chosen at compile
+            time. Every compare-exchange is a min/max pair without branches, so the cost
+            is the same for every input and the compiler can keep it all in registers.
+
+            TouchSmoother then smooths the stream of reduced measurements while a touch
+            is held, so a steady finger does not wander by a few counts from one sample
+            to the next. See TouchSmoother below.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>   // built-in
+
+class TouchFilter {
+public:
+  enum Reducer : uint8_t {
+    MEDIAN,         // middle element
+    TRIMMED_MEAN,   // average after dropping N/4 samples from each end
+    MINMAX_MEAN,    // average after dropping the single lowest and highest sample
+  };
+
+  static const uint8_t MAX_SAMPLES = 9;
+
+  // round a requested sample count to a supported one: 1, 3, 5, 7 or 9
+  static uint8_t supportedCount(uint8_t n) {
+    if (n <= 1) {
+      return 1;
+    }
+    if (n >= MAX_SAMPLES) {
+      return MAX_SAMPLES;
+    }
+    return n | 1;
+  }
+
+  // branch-free compare-exchange: afterwards a <= b
+  static inline void cswap(uint16_t &a, uint16_t &b) {
+    uint16_t lo = (a < b) ? a : b;
+    uint16_t hi = a ^ b ^ lo;
+    a           = lo;
+    b           = hi;
+  }
+
+  template <uint8_t N>
+  static void sort(uint16_t v[]);
+
+  /**
+   * @brief Reduce n samples to one value; n must be a supportedCount()
+   * @param v = samples, reordered in place by the median and trimmed mean reducers
+   */
+  static uint16_t reduce(uint16_t v[], uint8_t n, uint8_t reducer);
+};
+
+// optimal sorting networks, see Knuth TAOCP vol. 3, section 5.3.4
+template <>
+inline void TouchFilter::sort<3>(uint16_t v[]) {
+  cswap(v[1], v[2]);
+  cswap(v[0], v[2]);
+  cswap(v[0], v[1]);
+}
+
+template <>
+inline void TouchFilter::sort<5>(uint16_t v[]) {
+  cswap(v[0], v[1]);
+  cswap(v[3], v[4]);
+  cswap(v[2], v[4]);
+  cswap(v[2], v[3]);
+  cswap(v[0], v[3]);
+  cswap(v[0], v[2]);
+  cswap(v[1], v[4]);
+  cswap(v[1], v[3]);
+  cswap(v[1], v[2]);
+}
+
+template <>
+inline void TouchFilter::sort<7>(uint16_t v[]) {
+  cswap(v[1], v[2]);
+  cswap(v[3], v[4]);
+  cswap(v[5], v[6]);
+  cswap(v[0], v[2]);
+  cswap(v[3], v[5]);
+  cswap(v[4], v[6]);
+  cswap(v[0], v[1]);
+  cswap(v[4], v[5]);
+  cswap(v[2], v[6]);
+  cswap(v[0], v[4]);
+  cswap(v[1], v[5]);
+  cswap(v[0], v[3]);
+  cswap(v[2], v[5]);
+  cswap(v[1], v[3]);
+  cswap(v[2], v[4]);
+  cswap(v[2], v[3]);
+}
+
+template <>
+inline void TouchFilter::sort<9>(uint16_t v[]) {
+  cswap(v[0], v[1]);
+  cswap(v[3], v[4]);
+  cswap(v[6], v[7]);
+  cswap(v[1], v[2]);
+  cswap(v[4], v[5]);
+  cswap(v[7], v[8]);
+  cswap(v[0], v[1]);
+  cswap(v[3], v[4]);
+  cswap(v[6], v[7]);
+  cswap(v[0], v[3]);
+  cswap(v[3], v[6]);
+  cswap(v[0], v[3]);
+  cswap(v[1], v[4]);
+  cswap(v[4], v[7]);
+  cswap(v[1], v[4]);
+  cswap(v[2], v[5]);
+  cswap(v[5], v[8]);
+  cswap(v[2], v[5]);
+  cswap(v[1], v[3]);
+  cswap(v[5], v[7]);
+  cswap(v[2], v[6]);
+  cswap(v[4], v[6]);
+  cswap(v[2], v[4]);
+  cswap(v[2], v[3]);
+  cswap(v[5], v[6]);
+}
+
+inline uint16_t TouchFilter::reduce(uint16_t v[], uint8_t n, uint8_t reducer) {
+  if (n == 1) {
+    return v[0];
+  }
+  if (reducer == MINMAX_MEAN) {
+    // needs only the extremes, so skip sorting altogether
+    uint32_t sum = 0;
+    uint16_t lo  = 0xFFFF;
+    uint16_t hi  = 0;
+    for (uint8_t ii = 0; ii < n; ii++) {
+      sum += v[ii];
+      lo = (v[ii] < lo) ? v[ii] : lo;
+      hi = (v[ii] > hi) ? v[ii] : hi;
+    }
+    return (uint16_t)((sum - lo - hi + (n - 2) / 2) / (n - 2));
+  }
+
+  switch (n) {
+  case 3:
+    sort<3>(v);
+    break;
+  case 5:
+    sort<5>(v);
+    break;
+  case 7:
+    sort<7>(v);
+    break;
+  default:
+    sort<9>(v);
+    break;
+  }
+
+  if (reducer == TRIMMED_MEAN) {
+    uint8_t trim = n / 4;
+    uint32_t sum = 0;
+    for (uint8_t ii = trim; ii < n - trim; ii++) {
+      sum += v[ii];
+    }
+    uint8_t count = n - 2 * trim;
+    return (uint16_t)((sum + count / 2) / count);
+  }
+  return v[n / 2];   // MEDIAN
+}
+
+/*
+ * Streaming smoothing of touch coordinates, one sample at a time, in fixed point.
+ *
+ * IIR       exponential moving average: out += alpha * (in - out)
+ * ONE_EURO  the same, but alpha grows with the smoothed speed of the touch:
+ *           alpha = minAlpha + beta * speed. A resting touch is smoothed hard,
+ *           removing jitter, while a fast drag follows the finger closely.
+ *           This is the One-Euro filter of Casiez et al. (CHI 2012) with time
+ *           measured in samples and its cutoff-to-alpha curve made linear,
+ *           which is accurate for the small alphas that matter at rest.
+ *
+ * Alphas are in 1/256 (capped at 256 = no smoothing), speed is in counts per sample and
+ * the state is kept in 1/16 counts, so slow movements are not lost to rounding.
+ * Each axis keeps three integers; there is no history buffer.
+ */
+class TouchSmoother {
+public:
+  enum Mode : uint8_t {
+    OFF,        // pass measurements through unchanged
+    IIR,        // fixed alpha
+    ONE_EURO,   // speed-adaptive alpha
+  };
+
+  static const uint8_t FRACTION_BITS     = 4;    // of the filter state
+  static const uint8_t SPEED_ALPHA       = 64;   // smoothing of the speed estimate, 1/256
+  static const uint8_t DEFAULT_MIN_ALPHA = 32;   // at rest, each sample moves the output 1/8 of the way
+  static const uint8_t DEFAULT_BETA      = 16;   // plus 1/16 for every count per sample of speed
+
+  void configure(uint8_t mode, uint8_t minAlpha = DEFAULT_MIN_ALPHA, uint8_t beta = DEFAULT_BETA) {
+    _mode     = mode;
+    _minAlpha = minAlpha ? minAlpha : 1;
+    _beta     = beta;
+    reset();
+  }
+  uint8_t mode(void) const { return _mode; }
+
+  void reset(void) { _primed = false; }   // start over with the next sample, e.g. on a new touch
+
+  // smooth one measurement in place; the first after reset() passes through and primes the state
+  void apply(int16_t *x, int16_t *y) {
+    if (_mode == OFF) {
+      return;
+    }
+    if (!_primed) {
+      _x.prime(*x);
+      _y.prime(*y);
+      _primed = true;
+      return;
+    }
+    *x = _x.step(*x, _mode, _minAlpha, _beta);
+    *y = _y.step(*y, _mode, _minAlpha, _beta);
+  }
+
+protected:
+  class Axis {
+  public:
+    int32_t value = 0;   // filtered position, 1/16 counts
+    int32_t speed = 0;   // filtered change per sample, 1/16 counts
+    int16_t raw   = 0;   // previous input
+
+    void prime(int16_t in) {
+      value = (int32_t)in * (1 << FRACTION_BITS);
+      speed = 0;
+      raw   = in;
+    }
+
+    int16_t step(int16_t in, uint8_t mode, uint8_t minAlpha, uint8_t beta) {
+      uint32_t alpha = minAlpha;
+      if (mode == ONE_EURO) {
+        int32_t delta = (int32_t)(in - raw) * (1 << FRACTION_BITS);
+        speed += ((delta - speed) * SPEED_ALPHA) / 256;
+        alpha += ((uint32_t)beta * (uint32_t)abs(speed)) >> FRACTION_BITS;
+        if (alpha > 256) {
+          alpha = 256;
+        }
+      }
+      raw = in;
+      value += (((int32_t)in * (1 << FRACTION_BITS) - value) * (int32_t)alpha) / 256;
+      return (int16_t)((value + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS);
+    }
+  };
+
+  Axis _x, _y;
+  uint8_t _mode     = OFF;
+  uint8_t _minAlpha = DEFAULT_MIN_ALPHA;
+  uint8_t _beta     = DEFAULT_BETA;
+  bool _primed      = false;
+};
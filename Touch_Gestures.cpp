@@ -0,0 +1,170 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Gestures.cpp
+
+  Purpose:  Gesture recognizer for the touch event stream, see Touch_Gestures.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Gestures.h"
+
+/**
+ * @brief Consume one touch event
+ * @return true if *pGesture was filled with a completed gesture
+ */
+bool TouchGestureRecognizer::feed(const TouchEvent &event, TouchGesture *pGesture) {
+  switch (event.type) {
+  case TouchEvent::DOWN:
+    _down      = true;
+    _moved     = false;
+    _longFired = false;
+    _start     = event.point;
+    _startMs   = event.ms;
+    _stored    = 0;
+    remember(event);
+    return false;
+
+  case TouchEvent::MOVE:
+    if (!_down) {
+      return false;
+    }
+    remember(event);
+    if (!near(event.point, _start, tapSlop)) {
+      _moved = true;
+    }
+    return false;
+
+  case TouchEvent::UP:
+    return lifted(event, pGesture);
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Classify a touch that has just ended
+ */
+bool TouchGestureRecognizer::lifted(const TouchEvent &event, TouchGesture *pGesture) {
+  if (!_down) {
+    return false;
+  }
+  _down = false;
+  if (_longFired) {
+    return false;   // already reported while held
+  }
+  if (_moved) {
+    int dx = event.point.x - _start.x;
+    int dy = event.point.y - _start.y;
+    if (abs(dx) < swipeMin && abs(dy) < swipeMin) {
+      return false;   // wandered too far for a tap, not far enough for a swipe
+    }
+    pGesture->type = TouchGesture::SWIPE;
+    if (abs(dx) >= abs(dy)) {
+      pGesture->direction = (dx > 0) ? TouchGesture::RIGHT : TouchGesture::LEFT;
+    } else {
+      pGesture->direction = (dy > 0) ? TouchGesture::DOWN : TouchGesture::UP;
+    }
+    velocity(&pGesture->vx, &pGesture->vy);
+    pGesture->point = _start;
+    pGesture->ms    = event.ms;
+    return true;
+  }
+
+  // a tap: either completes a double-tap, is reported now, or waits for a second tap
+  pGesture->direction = TouchGesture::NOWHERE;
+  pGesture->vx        = 0;
+  pGesture->vy        = 0;
+  pGesture->ms        = event.ms;
+  if (_tapPending && (event.ms - _tapMs) <= doubleTapMs && near(_start, _tapPoint, tapSlop)) {
+    _tapPending     = false;
+    pGesture->type  = TouchGesture::DOUBLE_TAP;
+    pGesture->point = _tapPoint;
+    return true;
+  }
+  if (doubleTapMs == 0) {
+    pGesture->type  = TouchGesture::TAP;
+    pGesture->point = _start;
+    return true;
+  }
+  // an older tap that cannot pair with this one is reported now
+  bool flushed = _tapPending;
+  if (flushed) {
+    pGesture->type  = TouchGesture::TAP;
+    pGesture->point = _tapPoint;
+  }
+  _tapPending = true;
+  _tapPoint   = _start;
+  _tapMs      = event.ms;
+  return flushed;
+}
+
+/**
+ * @brief Report gestures that complete with time rather than with an event
+ * @param now = current time on the same clock as the event timestamps
+ * @return true if *pGesture was filled with a completed gesture
+ */
+bool TouchGestureRecognizer::poll(uint32_t now, TouchGesture *pGesture) {
+  pGesture->direction = TouchGesture::NOWHERE;
+  pGesture->vx        = 0;
+  pGesture->vy        = 0;
+  pGesture->ms        = now;
+
+  bool longPress = _down && !_moved && !_longFired && (now - _startMs) >= longPressMs;
+  if (_tapPending && (longPress || (now - _tapMs) > doubleTapMs)) {
+    // too late to pair, or the current touch is a long-press: report the earlier tap
+    // first, and the long-press on the next call
+    _tapPending     = false;
+    pGesture->type  = TouchGesture::TAP;
+    pGesture->point = _tapPoint;
+    return true;
+  }
+  if (longPress) {
+    _longFired      = true;
+    pGesture->type  = TouchGesture::LONG_PRESS;
+    pGesture->point = _start;
+    return true;
+  }
+  return false;
+}
+
+void TouchGestureRecognizer::reset(void) {
+  _down       = false;
+  _tapPending = false;
+  _stored     = 0;
+}
+
+void TouchGestureRecognizer::remember(const TouchEvent &event) {
+  _newest              = (_newest + 1) & (HISTORY - 1);
+  _history[_newest].x  = event.point.x;
+  _history[_newest].y  = event.point.y;
+  _history[_newest].ms = event.ms;
+  if (_stored < HISTORY) {
+    _stored++;
+  }
+}
+
+/**
+ * @brief Velocity across the history window, from its oldest to its newest point
+ */
+void TouchGestureRecognizer::velocity(int16_t *vx, int16_t *vy) const {
+  *vx = *vy = 0;
+  if (_stored < 2) {
+    return;
+  }
+  const Sample &newest = _history[_newest];
+  const Sample &oldest = _history[(_newest + 1 + HISTORY - _stored) & (HISTORY - 1)];
+  int32_t dt           = newest.ms - oldest.ms;
+  if (dt <= 0) {
+    return;
+  }
+  int32_t px = (int32_t)(newest.x - oldest.x) * 1000 / dt;
+  int32_t py = (int32_t)(newest.y - oldest.y) * 1000 / dt;
+  *vx        = (int16_t)constrain(px, -32767, 32767);
+  *vy        = (int16_t)constrain(py, -32767, 32767);
+}
+
+bool TouchGestureRecognizer::near(const ScreenPoint &a, const ScreenPoint &b, uint8_t distance) {
+  return abs(a.x - b.x) <= distance && abs(a.y - b.y) <= distance;
+}
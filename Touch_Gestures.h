@@ -0,0 +1,89 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Gestures.h
+
+  Purpose:  Classify the touch stream from Resistive_Touch_Screen::nextTouchEvent()
+            into taps, double-taps, long-presses and swipes with fling velocity.
+
+            Uses integer math and a fixed-size history of recent points; there is no
+            heap allocation. Feed every TouchEvent to feed(), and call poll() on every
+            pass through loop() for gestures that complete with the passage of time
+            (a long-press while still held, or a single tap once no second tap came).
+
+  Example:
+            TouchGestureRecognizer gestures;
+            void loop() {
+              TouchEvent event;
+              TouchGesture gesture;
+              if (tsn.nextTouchEvent(&event, tft.getRotation()) && gestures.feed(event, &gesture)) {
+                handle(gesture);
+              }
+              if (gestures.poll(millis(), &gesture)) {
+                handle(gesture);
+              }
+            }
+
+  License:  GNU General Public License v3.0
+*/
+#include <Resistive_Touch_Screen.h>
+
+class TouchGesture {
+public:
+  enum Type : uint8_t {
+    NONE,
+    TAP,          // short touch without travel
+    DOUBLE_TAP,   // two taps close together in place and time
+    LONG_PRESS,   // touch held in place, reported while still held
+    SWIPE,        // touch travelled and lifted, see direction and velocity
+  };
+  enum Direction : uint8_t {
+    NOWHERE,
+    LEFT,
+    RIGHT,
+    UP,     // toward y=0
+    DOWN,   // toward the bottom of the screen
+  };
+  uint8_t type      = NONE;
+  uint8_t direction = NOWHERE;
+  ScreenPoint point;   // where the gesture started
+  int16_t vx = 0;      // fling velocity at lift-off, pixels per second
+  int16_t vy = 0;
+  uint32_t ms = 0;   // when the gesture was recognized
+};
+
+class TouchGestureRecognizer {
+public:
+  // tuning, in milliseconds and pixels
+  uint16_t longPressMs = 600;   // hold at least this long for LONG_PRESS
+  uint16_t doubleTapMs = 300;   // max time from first lift to second lift; 0 reports every TAP at once
+  uint8_t tapSlop      = 10;    // a tap may wander this far and still be a tap
+  uint8_t swipeMin     = 40;    // a swipe must travel at least this far
+
+  bool feed(const TouchEvent &event, TouchGesture *pGesture);
+  bool poll(uint32_t now, TouchGesture *pGesture);
+  void reset(void);
+
+protected:
+  bool lifted(const TouchEvent &event, TouchGesture *pGesture);
+  void remember(const TouchEvent &event);
+  void velocity(int16_t *vx, int16_t *vy) const;
+  static bool near(const ScreenPoint &a, const ScreenPoint &b, uint8_t distance);
+
+  static const uint8_t HISTORY = 8;   // must be a power of two
+  struct Sample {
+    int16_t x, y;
+    uint32_t ms;
+  };
+  Sample _history[HISTORY];   // most recent points of the current touch
+  uint8_t _newest = 0;        // index of the latest entry in _history
+  uint8_t _stored = 0;        // number of valid entries in _history
+
+  bool _down       = false;   // touch in progress
+  bool _moved      = false;   // current touch left the tap slop
+  bool _longFired  = false;   // LONG_PRESS already reported for current touch
+  bool _tapPending = false;   // single tap waiting to see if a second tap follows
+  ScreenPoint _start;         // where the current touch began
+  uint32_t _startMs = 0;
+  ScreenPoint _tapPoint;      // where the pending tap was
+  uint32_t _tapMs = 0;        // when the pending tap was lifted
+};
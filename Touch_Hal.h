@@ -0,0 +1,204 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Hal.h
+
+  Purpose:  Hardware abstraction for the four plates of a resistive touch screen.
+            Resistive_Touch_Screen performs all of its pin and ADC operations through
+            a TouchHal, so the same measurement code can run against the real pins
+            (ArduinoTouchHal, or PortTouchHal on SAMD) or against a model of the panel
+            (SimulatedTouchPanel).
+
+            Plates are addressed by role (X+, Y+, X-, Y-) rather than by pin number;
+            each backend decides how a role maps onto hardware.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>   // built-in
+
+class TouchHal {
+public:
+  enum Plate : uint8_t {
+    XP = 0,   // X+
+    YP,       // Y+
+    XM,       // X-
+    YM,       // Y-
+    NUM_PLATES,
+  };
+
+  // measurement phases, each of which drives two plates and leaves the other two as inputs
+  enum Phase : uint8_t {
+    DRIVE_X = 0,   // X+ high, X- low, sense on Y+
+    DRIVE_Y,       // Y+ high, Y- low, sense on X-
+    DRIVE_Z,       // X+ low, Y- high, sense Z1 on X- and Z2 on Y+
+    NUM_PHASES,
+  };
+  // plates driven in a phase, one bit per plate; the other plates are inputs, written LOW
+  static uint8_t phaseOutputs(uint8_t phase) {
+    static const uint8_t outputs[NUM_PHASES] = {(1 << XP) | (1 << XM), (1 << YP) | (1 << YM), (1 << XP) | (1 << YM)};
+    return outputs[phase];
+  }
+  // plates driven HIGH in a phase, one bit per plate
+  static uint8_t phaseHighs(uint8_t phase) {
+    static const uint8_t highs[NUM_PHASES] = {(1 << XP), (1 << YP), (1 << YM)};
+    return highs[phase];
+  }
+
+  virtual void setPinMode(uint8_t plate, uint8_t mode) = 0;   // INPUT or OUTPUT
+  virtual void writePin(uint8_t plate, uint8_t level)  = 0;   // LOW or HIGH
+  virtual int readPin(uint8_t plate)                   = 0;   // analog conversion 0..1023
+  virtual uint32_t millis(void) { return ::millis(); }      // clock for event timestamps
+  virtual uint32_t micros(void) { return ::micros(); }      // clock for scheduling and timing
+  virtual void delayMicroseconds(uint16_t us) { ::delayMicroseconds(us); }
+  virtual uint32_t cycles(void) { return ::micros(); }      // fine-grained ticks for instrumentation
+
+  // Switch every plate to a phase at once, from phase from, or from an unknown state if
+  // from is NUM_PHASES. A backend overrides this if it can do better than one setPinMode()
+  // and writePin() per plate; false leaves it to those calls.
+  virtual bool drivePhase(uint8_t phase, uint8_t from) {
+    (void)phase;
+    (void)from;
+    return false;
+  }
+};
+
+/*
+ * Backend for real hardware using the Arduino pin functions
+ */
+class ArduinoTouchHal : public TouchHal {
+public:
+  ArduinoTouchHal(uint8_t x_plus_pin, uint8_t y_plus_pin, uint8_t x_minus_pin, uint8_t y_minus_pin)
+      : _pins{x_plus_pin, y_plus_pin, x_minus_pin, y_minus_pin} {}
+
+  void setPinMode(uint8_t plate, uint8_t mode) override { pinMode(_pins[plate], mode); }
+  void writePin(uint8_t plate, uint8_t level) override { digitalWrite(_pins[plate], level); }
+  int readPin(uint8_t plate) override { return analogRead(_pins[plate]); }
+
+#if defined(__SAMD51__)
+  // count CPU clock cycles with the Cortex-M4 DWT unit, started on first use
+  uint32_t cycles(void) override {
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CYCCNT = 0;
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+  }
+#endif
+
+protected:
+  uint8_t _pins[NUM_PLATES];
+};
+
+#if defined(ARDUINO_ARCH_SAMD) || defined(RTS_MOCK_PORT)
+/*
+ * Backend for SAMD21/SAMD51 that writes the PORT registers directly.
+ * The port group and bit of each plate are looked up once in the constructor,
+ * along with the DIR and OUT masks of each phase in each port group, so drivePhase()
+ * switches all four plates with a few set and clear writes, only for the bits that
+ * change, instead of a trip through pinMode() and digitalWrite() for each plate.
+ * Conversions still use analogRead(). The host build compiles it against a mock
+ * of the registers, see extras/host/Mock_Port.h.
+ */
+class PortTouchHal : public ArduinoTouchHal {
+public:
+  PortTouchHal(uint8_t x_plus_pin, uint8_t y_plus_pin, uint8_t x_minus_pin, uint8_t y_minus_pin)
+      : ArduinoTouchHal(x_plus_pin, y_plus_pin, x_minus_pin, y_minus_pin) {
+    memset(_masks, 0, sizeof(_masks));
+    _groups = 0;
+    for (uint8_t plate = 0; plate < NUM_PLATES; plate++) {
+      const PinDescription &pin = g_APinDescription[_pins[plate]];
+      _port[plate]              = &PORT->Group[pin.ulPort];
+      _bit[plate]               = pin.ulPin;
+
+      uint8_t g = 0;
+      while (g < _groups && _masks[g].port != _port[plate]) {
+        g++;
+      }
+      if (g == _groups) {
+        _masks[_groups++].port = _port[plate];
+      }
+      uint32_t mask = (1ul << _bit[plate]);
+      _masks[g].plates |= mask;
+      for (uint8_t phase = 0; phase < NUM_PHASES; phase++) {
+        if (phaseOutputs(phase) & (1 << plate)) {
+          _masks[g].outputs[phase] |= mask;
+        }
+        if (phaseHighs(phase) & (1 << plate)) {
+          _masks[g].highs[phase] |= mask;
+        }
+      }
+    }
+  }
+
+  // same register sequence as the SAMD core's pinMode(), minus the pin table lookups
+  void setPinMode(uint8_t plate, uint8_t mode) override {
+    PortGroup *port = _port[plate];
+    if (mode == OUTPUT) {
+      port->PINCFG[_bit[plate]].reg = (uint8_t)(PORT_PINCFG_INEN | PORT_PINCFG_DRVSTR);
+      port->DIRSET.reg              = (1ul << _bit[plate]);
+    } else {
+      port->PINCFG[_bit[plate]].reg = (uint8_t)(PORT_PINCFG_INEN);
+      port->DIRCLR.reg              = (1ul << _bit[plate]);
+    }
+  }
+  void writePin(uint8_t plate, uint8_t level) override {
+    if (level == HIGH) {
+      _port[plate]->OUTSET.reg = (1ul << _bit[plate]);
+    } else {
+      _port[plate]->OUTCLR.reg = (1ul << _bit[plate]);
+    }
+  }
+
+  // Release the new inputs in every group first, then set the levels, then drive the
+  // new outputs, so no plate is driven while the last phase's outputs still are. New
+  // outputs get the PINCFG setPinMode() writes, which also undoes analogRead().
+  bool drivePhase(uint8_t phase, uint8_t from) override {
+    for (uint8_t g = 0; g < _groups; g++) {
+      uint32_t dirs = (from < NUM_PHASES) ? _masks[g].outputs[from] ^ _masks[g].outputs[phase] : _masks[g].plates;
+      if (dirs & ~_masks[g].outputs[phase]) {
+        _masks[g].port->DIRCLR.reg = dirs & ~_masks[g].outputs[phase];
+      }
+    }
+    for (uint8_t g = 0; g < _groups; g++) {
+      uint32_t levels = (from < NUM_PHASES) ? _masks[g].highs[from] ^ _masks[g].highs[phase] : _masks[g].plates;
+      if (levels & ~_masks[g].highs[phase]) {
+        _masks[g].port->OUTCLR.reg = levels & ~_masks[g].highs[phase];
+      }
+      if (levels & _masks[g].highs[phase]) {
+        _masks[g].port->OUTSET.reg = levels & _masks[g].highs[phase];
+      }
+    }
+    for (uint8_t g = 0; g < _groups; g++) {
+      uint32_t dirs    = (from < NUM_PHASES) ? _masks[g].outputs[from] ^ _masks[g].outputs[phase] : _masks[g].plates;
+      uint32_t outputs = dirs & _masks[g].outputs[phase];
+      if (outputs & 0xFFFF) {
+        _masks[g].port->WRCONFIG.reg = PIN_CONFIG | PORT_WRCONFIG_PINMASK(outputs);
+      }
+      if (outputs >> 16) {
+        _masks[g].port->WRCONFIG.reg = PIN_CONFIG | PORT_WRCONFIG_HWSEL | PORT_WRCONFIG_PINMASK(outputs >> 16);
+      }
+      if (outputs) {
+        _masks[g].port->DIRSET.reg = outputs;
+      }
+    }
+    return true;
+  }
+
+protected:
+  // WRCONFIG of an output, as setPinMode() leaves its PINCFG; add the pins and half
+  static const uint32_t PIN_CONFIG = PORT_WRCONFIG_WRPINCFG | PORT_WRCONFIG_INEN | PORT_WRCONFIG_DRVSTR;
+
+  // the plates in one port group, as bits of its registers
+  struct GroupMasks {
+    PortGroup *port;
+    uint32_t plates;                // every plate in this group
+    uint32_t outputs[NUM_PHASES];   // plates driven in each phase
+    uint32_t highs[NUM_PHASES];     // plates driven HIGH in each phase
+  };
+
+  PortGroup *_port[NUM_PLATES];    // PORT->Group[] of each plate
+  uint8_t _bit[NUM_PLATES];        // bit number within its port group
+  GroupMasks _masks[NUM_PLATES];   // one per port group used
+  uint8_t _groups;                 // entries used in _masks[]
+};
+#endif
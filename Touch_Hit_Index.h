@@ -0,0 +1,160 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Hit_Index.h
+
+  Purpose:  Find which on-screen control contains a touch, without scanning every control.
+
+            Register each control's rectangle with an ID, call build(), then pass the
+            ScreenPoint from newScreenTap() to find(). The screen is divided into a coarse
+            grid of power-of-two sized cells; each cell lists only the controls that overlap
+            it, so a lookup examines a handful of rectangles however many are registered.
+
+            Storage is fixed by the template parameters, there is no heap allocation.
+            If the controls overlap so many cells that the cell lists do not fit,
+            find() quietly falls back to a linear scan.
+
+  Example:
+            TouchHitIndex<50> buttons;           // one index per screen layout
+            buttons.begin(tft.width(), tft.height());
+            buttons.add(ID_MENU, 0, 0, 60, 40);  // id, x, y, width, height in pixels
+            ...
+            buttons.build();
+            int16_t id = buttons.find(screen);   // NO_CONTROL if nothing was hit
+
+  License:  GNU General Public License v3.0
+*/
+#include <Resistive_Touch_Screen.h>
+
+template <uint16_t MAX_CONTROLS, uint8_t COLS = 8, uint8_t ROWS = 8>
+class TouchHitIndex {
+public:
+  static const int16_t NO_CONTROL = -1;
+
+  // start a new layout for a screen of the given size, in pixels
+  void begin(uint16_t width, uint16_t height) {
+    _count   = 0;
+    _indexed = false;
+    _colBits = shiftFor(width, COLS);
+    _rowBits = shiftFor(height, ROWS);
+  }
+
+  // register a control; where controls overlap, the one added last wins
+  bool add(int16_t id, int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (_count >= MAX_CONTROLS || w <= 0 || h <= 0) {
+      return false;
+    }
+    _rects[_count++] = {x, y, w, h, id};
+    _indexed         = false;
+    return true;
+  }
+
+  // fill the grid cells; call after the last add()
+  void build(void) {
+    uint16_t total = 0;   // count entries per cell, then turn counts into start offsets
+    for (uint16_t cell = 0; cell <= CELLS; cell++) {
+      _cellStart[cell] = 0;
+    }
+    for (uint16_t ii = 0; ii < _count; ii++) {
+      uint8_t col0, col1, row0, row1;
+      cellRange(_rects[ii], &col0, &col1, &row0, &row1);
+      for (uint8_t row = row0; row <= row1; row++) {
+        for (uint8_t col = col0; col <= col1; col++) {
+          _cellStart[row * COLS + col + 1]++;
+        }
+      }
+    }
+    for (uint16_t cell = 0; cell < CELLS; cell++) {
+      total += _cellStart[cell + 1];
+      _cellStart[cell + 1] = total;
+    }
+    if (total > ENTRIES) {
+      _indexed = false;   // too many overlaps for the fixed storage
+      return;
+    }
+    uint16_t fill[CELLS];
+    for (uint16_t cell = 0; cell < CELLS; cell++) {
+      fill[cell] = _cellStart[cell];
+    }
+    for (uint16_t ii = 0; ii < _count; ii++) {
+      uint8_t col0, col1, row0, row1;
+      cellRange(_rects[ii], &col0, &col1, &row0, &row1);
+      for (uint8_t row = row0; row <= row1; row++) {
+        for (uint8_t col = col0; col <= col1; col++) {
+          uint16_t cell            = row * COLS + col;
+          _cellItems[fill[cell]++] = ii;
+        }
+      }
+    }
+    _indexed = true;
+  }
+
+  // ID of the control containing the point, or NO_CONTROL
+  int16_t find(const TSPoint &p) const {
+    if (!_indexed) {
+      return findLinear(p);
+    }
+    // clamp like build() does, so points on or past the screen edge find the same controls
+    uint16_t cell = cellIndex(p.y, _rowBits, ROWS) * COLS + cellIndex(p.x, _colBits, COLS);
+    for (uint16_t jj = _cellStart[cell + 1]; jj > _cellStart[cell]; jj--) {   // newest first
+      const Rect &r = _rects[_cellItems[jj - 1]];
+      if (r.contains(p)) {
+        return r.id;
+      }
+    }
+    return NO_CONTROL;
+  }
+
+  // reference implementation: examine every control
+  int16_t findLinear(const TSPoint &p) const {
+    for (uint16_t ii = _count; ii > 0; ii--) {
+      if (_rects[ii - 1].contains(p)) {
+        return _rects[ii - 1].id;
+      }
+    }
+    return NO_CONTROL;
+  }
+
+  uint16_t count(void) const { return _count; }
+  bool indexed(void) const { return _indexed; }
+
+protected:
+  static const uint16_t CELLS   = COLS * ROWS;
+  static const uint16_t ENTRIES = MAX_CONTROLS * 4;   // room for each control to cover 4 cells
+
+  struct Rect {
+    int16_t x, y, w, h, id;
+    bool contains(const TSPoint &p) const {
+      return p.x >= x && p.x < x + w && p.y >= y && p.y < y + h;
+    }
+  };
+
+  // smallest cell size, as a power of two, that covers "extent" pixels in "cells" cells
+  static uint8_t shiftFor(uint16_t extent, uint8_t cells) {
+    uint8_t bits = 0;
+    while (extent > 0 && ((uint16_t)(extent - 1) >> bits) >= cells) {
+      bits++;
+    }
+    return bits;
+  }
+
+  // first and last grid column and row that a rectangle overlaps
+  void cellRange(const Rect &r, uint8_t *col0, uint8_t *col1, uint8_t *row0, uint8_t *row1) const {
+    *col0 = cellIndex(r.x, _colBits, COLS);
+    *col1 = cellIndex(r.x + r.w - 1, _colBits, COLS);
+    *row0 = cellIndex(r.y, _rowBits, ROWS);
+    *row1 = cellIndex(r.y + r.h - 1, _rowBits, ROWS);
+  }
+  static uint8_t cellIndex(int32_t pixel, uint8_t bits, uint8_t cells) {
+    int32_t index = (pixel < 0) ? 0 : (pixel >> bits);
+    return (index >= cells) ? (cells - 1) : index;
+  }
+
+  Rect _rects[MAX_CONTROLS];
+  uint16_t _count  = 0;
+  bool _indexed    = false;   // grid is up to date with _rects
+  uint8_t _colBits = 0;       // cell width is 1 << _colBits pixels
+  uint8_t _rowBits = 0;       // cell height is 1 << _rowBits pixels
+
+  uint16_t _cellStart[CELLS + 1];   // cell n lists _cellItems[_cellStart[n] .. _cellStart[n+1]-1]
+  uint16_t _cellItems[ENTRIES];     // indexes into _rects, in order of registration
+};
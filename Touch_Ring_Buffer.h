@@ -0,0 +1,57 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Ring_Buffer.h
+
+  Purpose:  Single-producer / single-consumer ring buffer without locks.
+            The producer is typically a timer interrupt calling Resistive_Touch_Screen::sampleFromISR()
+            and the consumer is the main loop() calling Resistive_Touch_Screen::readSample().
+
+            Only the producer writes "_head" and only the consumer writes "_tail",
+            so neither side needs to disable interrupts. One slot is always left
+            empty to tell "full" apart from "empty".
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>   // built-in
+
+template <typename T, uint8_t SIZE>
+class TouchRingBuffer {
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+  // producer side: returns false and counts an overrun if the buffer is full
+  bool push(const T &item) {
+    uint8_t head = _head;
+    uint8_t next = (head + 1) & (SIZE - 1);
+    if (next == _tail) {
+      _dropped++;
+      return false;
+    }
+    _items[head] = item;
+    __sync_synchronize();   // item must be visible before it is published
+    _head = next;
+    return true;
+  }
+
+  // consumer side: returns false if there is nothing to read
+  bool pop(T *item) {
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    *item = _items[tail];
+    __sync_synchronize();   // finish reading before the slot is released
+    _tail = (tail + 1) & (SIZE - 1);
+    return true;
+  }
+
+  uint8_t count() const { return (_head - _tail) & (SIZE - 1); }
+  uint16_t dropped() const { return _dropped; }   // samples lost because the consumer fell behind
+  void clear() { _tail = _head; }                 // consumer side only
+
+private:
+  T _items[SIZE];
+  volatile uint8_t _head     = 0;   // next slot to write, owned by producer
+  volatile uint8_t _tail     = 0;   // next slot to read, owned by consumer
+  volatile uint16_t _dropped = 0;   // owned by producer
+};
@@ -0,0 +1,89 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Simulator.cpp
+
+  Purpose:  Model of a 4-wire resistive panel, see Touch_Simulator.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Simulator.h"
+
+void SimulatedTouchPanel::setPinMode(uint8_t plate, uint8_t mode) {
+  pinModeCalls++;
+  if (_mode[plate] != mode) {
+    _changedUs = _nowUs;
+  }
+  _mode[plate] = mode;
+}
+
+void SimulatedTouchPanel::writePin(uint8_t plate, uint8_t level) {
+  writeCalls++;
+  if (_level[plate] != level) {
+    _changedUs = _nowUs;
+  }
+  _level[plate] = level;
+}
+
+/**
+ * @brief Simulate an analog conversion on one plate
+ *
+ * Resistances along each plate, measured from the contact point:
+ *   X plate: contact to X+ = rx * x / 1023
+ *   Y plate: contact to Y- = ry * (1023 - y) / 1023
+ */
+int SimulatedTouchPanel::readPin(uint8_t plate) {
+  readCalls++;
+  _nowUs += _conversionUs;
+  int32_t rxc = (int32_t)_rx * _x / 1023;            // contact to X+
+  int32_t ryc = (int32_t)_ry * (1023 - _y) / 1023;   // contact to Y-
+
+  if (driven(XP, HIGH) && driven(XM, LOW) && (plate == YP || plate == YM)) {
+    // X measurement: the Y plate picks up the X plate's voltage at the contact point
+    return _touching ? noisy(1023 - _x) : noisy(0);
+  }
+
+  if (driven(YP, HIGH) && driven(YM, LOW) && (plate == XP || plate == XM)) {
+    // Y measurement: the X plate picks up the Y plate's voltage at the contact point
+    return _touching ? noisy(1023 - _y) : noisy(0);
+  }
+
+  if (driven(XP, LOW) && driven(YM, HIGH)) {
+    // Z measurement: current flows from Y- through the contact into X+
+    if (!_touching) {
+      return (plate == XM) ? noisy(0) : noisy(1023);   // X- sits at ground, Y+ at VCC
+    }
+    int32_t total = ryc + _contact_ohms + rxc;
+    if (total == 0) {
+      total = 1;
+    }
+    if (plate == XM) {
+      return noisy(1023 * rxc / total);   // Z1
+    }
+    if (plate == YP) {
+      return noisy(1023 * (rxc + _contact_ohms) / total);   // Z2
+    }
+  }
+
+  return noisy(0);   // floating or unsupported configuration
+}
+
+/**
+ * @brief Add uniform noise and clamp to the ADC range
+ *
+ * The noise is +/- _noise counts, plus up to _settleNoise counts if the plates
+ * were switched less than _settleUs ago.
+ */
+int SimulatedTouchPanel::noisy(int32_t value) {
+  int32_t amplitude = _noise;
+  uint32_t elapsed  = _nowUs - _changedUs;
+  if (elapsed < _settleUs) {
+    amplitude += (int32_t)_settleNoise * (_settleUs - elapsed) / _settleUs;
+  }
+  if (amplitude) {
+    _seed        = _seed * 1664525UL + 1013904223UL;   // LCG from Numerical Recipes
+    int32_t span = 2 * amplitude + 1;
+    value += (int32_t)((_seed >> 8) % span) - amplitude;
+  }
+  return constrain(value, 0, 1023);
+}
@@ -0,0 +1,99 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Simulator.h
+
+  Purpose:  A TouchHal backend that models a 4-wire resistive panel instead of driving pins.
+            Use it to exercise Resistive_Touch_Screen without hardware, for example
+            on a desktop computer or to demonstrate the library on a bare board.
+
+            The model has two resistive plates (X+ to X-, Y+ to Y-) that touch at
+            one point through a contact resistance. The contact point is given in the
+            same units readTouchX() and readTouchY() report (0..1023), so a simulated
+            touch at (x,y) reads back as (x,y) apart from the configured ADC noise.
+
+  License:  GNU General Public License v3.0
+*/
+#include "Touch_Hal.h"
+
+class SimulatedTouchPanel : public TouchHal {
+public:
+  /**
+   * @param rx_ohms Plate resistance between X+ and X-
+   * @param ry_ohms Plate resistance between Y+ and Y-
+   */
+  SimulatedTouchPanel(uint16_t rx_ohms = 310, uint16_t ry_ohms = 590)
+      : _rx(rx_ohms), _ry(ry_ohms) {}
+
+  // press the panel at (x,y) in touch units 0..1023, with the given contact resistance
+  void touch(int16_t x, int16_t y, uint16_t contact_ohms = 400) {
+    _touching     = true;
+    _x            = constrain(x, 0, 1023);
+    _y            = constrain(y, 0, 1023);
+    _contact_ohms = contact_ohms;
+  }
+  void release(void) { _touching = false; }
+  bool isPressed(void) const { return _touching; }
+
+  // amplitude of random noise added to every conversion, in ADC counts
+  void setNoise(uint16_t counts) { _noise = counts; }
+
+  // conversions within settle_us of a pin change get up to extra_counts more noise,
+  // fading linearly as the plates settle
+  void setSettling(uint16_t settle_us, uint16_t extra_counts) {
+    _settleUs    = settle_us;
+    _settleNoise = extra_counts;
+  }
+  void setSeed(uint32_t seed) { _seed = seed; }
+
+  // simulated time only moves forward when advanced, or by the cost of each conversion,
+  // so runs are repeatable
+  void advanceMillis(uint32_t ms) { _nowUs += ms * 1000; }
+  void advanceMicros(uint32_t us) { _nowUs += us; }
+  void setConversionMicros(uint16_t us) { _conversionUs = us; }
+
+  // TouchHal
+  void setPinMode(uint8_t plate, uint8_t mode) override;
+  void writePin(uint8_t plate, uint8_t level) override;
+  int readPin(uint8_t plate) override;
+  uint32_t millis(void) override {
+    clockCalls++;
+    return _nowUs / 1000;
+  }
+  uint32_t micros(void) override {
+    clockCalls++;
+    return _nowUs;
+  }
+  void delayMicroseconds(uint16_t us) override {
+    clockCalls++;
+    _nowUs += us;
+  }
+
+  // number of calls into this backend, for measuring the cost of an operation
+  uint32_t pinModeCalls = 0;
+  uint32_t writeCalls   = 0;
+  uint32_t readCalls    = 0;
+  uint32_t clockCalls   = 0;   // millis(), micros() and delayMicroseconds()
+  void resetCounters(void) { pinModeCalls = writeCalls = readCalls = clockCalls = 0; }
+
+protected:
+  bool driven(uint8_t plate, uint8_t level) const {
+    return _mode[plate] == OUTPUT && _level[plate] == level;
+  }
+  int noisy(int32_t value);
+
+  uint16_t _rx, _ry;
+  bool _touching         = false;
+  int16_t _x             = 0;
+  int16_t _y             = 0;
+  uint16_t _contact_ohms = 400;
+  uint16_t _noise        = 0;
+  uint32_t _seed         = 12345;
+  uint32_t _nowUs        = 0;
+  uint16_t _conversionUs = 0;   // simulated time taken by each readPin()
+  uint16_t _settleUs     = 0;
+  uint16_t _settleNoise  = 0;
+  uint32_t _changedUs    = 0;   // time of the last pin change
+
+  uint8_t _mode[NUM_PLATES]  = {INPUT, INPUT, INPUT, INPUT};
+  uint8_t _level[NUM_PLATES] = {LOW, LOW, LOW, LOW};
+};
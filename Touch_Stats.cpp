@@ -0,0 +1,44 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Stats.cpp
+
+  Purpose:  Report the touchscreen instrumentation, see Touch_Stats.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Stats.h"
+
+void TouchHistogram::dump(Print &out, const char *name) const {
+  char msg[96];
+  if (_count == 0) {
+    snprintf(msg, sizeof(msg), "%-8s n=0", name);
+    out.println(msg);
+    return;
+  }
+  snprintf(msg, sizeof(msg), "%-8s n=%lu min=%lu mean=%lu max=%lu",
+           name, (unsigned long)_count, (unsigned long)_min,
+           (unsigned long)(_sum / _count), (unsigned long)_max);
+  out.println(msg);
+
+  for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+    if (_buckets[bucket]) {
+      uint32_t upper = (bucket == BUCKETS - 1) ? 0xFFFFFFFF : ((1UL << bucket) - 1);
+      snprintf(msg, sizeof(msg), "  <= %lu: %u", (unsigned long)upper, _buckets[bucket]);
+      out.println(msg);
+    }
+  }
+}
+
+void TouchStats::dump(Print &out) const {
+  static const char *const names[NUM_PHASES] = {"drive", "settle", "convert", "filter", "map"};
+
+  out.println("----- Touch screen instrumentation (ticks)");
+  for (uint8_t p = 0; p < NUM_PHASES; p++) {
+    phase[p].dump(out, names[p]);
+  }
+  char msg[96];
+  snprintf(msg, sizeof(msg), "taps=%lu rejected=%lu transitions=%lu",
+           (unsigned long)taps, (unsigned long)rejected, (unsigned long)transitions);
+  out.println(msg);
+}
@@ -0,0 +1,88 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Stats.h
+
+  Purpose:  Optional instrumentation of the touchscreen hot path.
+
+            When RTS_INSTRUMENTATION is non-zero, Resistive_Touch_Screen records how many
+            clock ticks each phase of a measurement takes (drive, settle, convert, filter,
+            map) into histograms with power-of-two buckets, and counts taps, rejected
+            samples and hysteresis transitions. Call dumpStats(Serial) to print them.
+
+            When RTS_INSTRUMENTATION is zero (the default), the timing macros expand to
+            nothing and no memory is used, so there is no cost at all.
+
+            Arduino compiles libraries separately from the sketch, so a #define in the
+            sketch does not reach this library. Enable it with a compiler flag such as
+            -DRTS_INSTRUMENTATION=1 (e.g. PlatformIO "build_flags"), or edit the default below.
+
+            Ticks come from TouchHal::cycles(): the CPU cycle counter on SAMD51, otherwise
+            micros() from the platform's monotonic clock.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>   // built-in
+
+#ifndef RTS_INSTRUMENTATION
+#define RTS_INSTRUMENTATION 0
+#endif
+
+// histogram of durations; bucket n counts durations of 2^(n-1) up to 2^n - 1 ticks
+class TouchHistogram {
+public:
+  static const uint8_t BUCKETS = 24;
+
+  void record(uint32_t ticks) {
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS - 1 && (ticks >> bucket)) {
+      bucket++;
+    }
+    if (_buckets[bucket] < 0xFFFF) {
+      _buckets[bucket]++;
+    }
+    _count++;
+    _sum += ticks;
+    _min = (ticks < _min) ? ticks : _min;
+    _max = (ticks > _max) ? ticks : _max;
+  }
+  void reset(void) { *this = TouchHistogram(); }
+  void dump(Print &out, const char *name) const;
+
+protected:
+  uint16_t _buckets[BUCKETS] = {0};
+  uint32_t _count            = 0;
+  uint64_t _sum              = 0;
+  uint32_t _min              = 0xFFFFFFFF;
+  uint32_t _max              = 0;
+};
+
+class TouchStats {
+public:
+  enum Phase : uint8_t {
+    DRIVE,     // switching the plates
+    SETTLE,    // waiting for the plates to settle
+    CONVERT,   // one analog conversion
+    FILTER,    // combining oversampled values
+    MAP,       // converting a touch into screen coordinates
+    NUM_PHASES,
+  };
+
+  TouchHistogram phase[NUM_PHASES];
+  uint32_t taps        = 0;   // touches reported by newScreenTap(), pollScreenTap() or as DOWN events
+  uint32_t rejected    = 0;   // samples with some pressure, but not enough to start a touch
+  uint32_t transitions = 0;   // hysteresis changes between touched and not touched
+
+  void record(uint8_t p, uint32_t ticks) { phase[p].record(ticks); }
+  void reset(void) { *this = TouchStats(); }
+  void dump(Print &out) const;
+};
+
+#if RTS_INSTRUMENTATION
+#define RTS_TIMER_START(t)       uint32_t t = _hal->cycles()
+#define RTS_TIMER_STOP(t, phase) _stats.record(TouchStats::phase, _hal->cycles() - (t))
+#define RTS_COUNT(counter)       _stats.counter++
+#else
+#define RTS_TIMER_START(t)
+#define RTS_TIMER_STOP(t, phase)
+#define RTS_COUNT(counter)
+#endif
@@ -0,0 +1,108 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Trace.cpp
+
+  Purpose:  Touch trace recording and replay, see Touch_Trace.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "Touch_Trace.h"
+
+const char TouchTrace::MAGIC[3] = {'R', 'T', 'T'};
+
+// ========== TouchTraceRecorder ==========
+void TouchTraceRecorder::begin(void) {
+  _out.write((const uint8_t *)TouchTrace::MAGIC, sizeof(TouchTrace::MAGIC));
+  _out.write(TouchTrace::VERSION);
+  _lastUs = _hal->micros();
+  for (int ii = 0; ii < NUM_PLATES; ii++) {
+    _last[ii] = 0;
+  }
+  recorded = 0;
+}
+
+int TouchTraceRecorder::readPin(uint8_t plate) {
+  uint32_t now = _hal->micros();
+  int value    = _hal->readPin(plate);
+
+  writeVarint(now - _lastUs);
+  writeVarint((TouchTrace::zigzag(value - _last[plate]) << 2) | plate);
+  _lastUs      = now;
+  _last[plate] = value;
+  recorded++;
+  return value;
+}
+
+void TouchTraceRecorder::writeVarint(uint32_t v) {
+  while (v >= 0x80) {
+    _out.write((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  _out.write((uint8_t)v);
+}
+
+// ========== TouchTraceReplay ==========
+bool TouchTraceReplay::load(const uint8_t *trace, size_t size) {
+  _next        = nullptr;
+  _end         = nullptr;
+  _nowUs       = 0;
+  _nextDeltaUs = 0;
+  _waiting     = true;
+  _diverged    = false;
+  replayed     = 0;
+  for (int ii = 0; ii < NUM_PLATES; ii++) {
+    _last[ii] = 0;
+  }
+
+  if (size < TouchTrace::HEADER_SIZE || memcmp(trace, TouchTrace::MAGIC, sizeof(TouchTrace::MAGIC)) != 0 || trace[3] != TouchTrace::VERSION) {
+    return false;   // not a trace we understand; replay reads as finished
+  }
+  _next = trace + TouchTrace::HEADER_SIZE;
+  _end  = trace + size;
+  fetch();
+  return true;
+}
+
+/**
+ * @brief Return the next recorded conversion, which must be for the same plate
+ */
+int TouchTraceReplay::readPin(uint8_t plate) {
+  uint32_t tag;
+  if (_next == nullptr || !readVarint(&tag)) {
+    _next = nullptr;
+    return 0;
+  }
+  if ((tag & 3) != plate) {
+    _diverged = true;   // the screen is not configured as it was when recording
+    _next     = nullptr;
+    return 0;
+  }
+  _nowUs += _nextDeltaUs;
+  _waiting = false;
+  _last[plate] += TouchTrace::unzigzag(tag >> 2);
+  replayed++;
+  fetch();
+  return _last[plate];
+}
+
+void TouchTraceReplay::fetch(void) {
+  if (_next == _end || !readVarint(&_nextDeltaUs)) {
+    _next        = nullptr;
+    _nextDeltaUs = 0;
+  }
+}
+
+bool TouchTraceReplay::readVarint(uint32_t *v) {
+  *v            = 0;
+  uint8_t shift = 0;
+  while (_next < _end && shift < 32) {
+    uint8_t b = *_next++;
+    *v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      return true;
+    }
+    shift += 7;
+  }
+  return false;   // truncated or corrupt
+}
@@ -0,0 +1,160 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Trace.h
+
+  Purpose:  Record the raw conversions of a touchscreen session and play them back later.
+
+            TouchTraceRecorder sits between Resistive_Touch_Screen and the real backend.
+            It passes every call through and writes each analog conversion (X, Y, Z1, Z2)
+            with its timestamp to a Print, e.g. Serial or a TouchTraceBuffer.
+
+            TouchTraceReplay is a backend that answers readPin() from such a trace instead
+            of the ADC, so a session captured on a misbehaving unit runs through exactly the
+            same filtering, hysteresis and mapping code on another board or a desktop.
+            Replay does no I/O and never waits, so thousands of traces can be replayed
+            quickly as a regression suite.
+
+            The screen must be configured the same way (oversampling, settling, poll rate)
+            for replay as for recording, so that it asks for the same conversions in the
+            same order. If it asks for a different plate than was recorded, the replay
+            stops and diverged() returns true.
+
+  Format:   A 4 byte header "RTT" followed by the version, then one record per conversion:
+              varint  microseconds since the previous conversion
+              varint  (zigzag(value - previous value on this plate) << 2) | plate
+            Varints hold 7 bits per byte, low bits first, high bit set on all but the last.
+            Back-to-back conversions of a steady touch take 2 bytes; the first conversion
+            of a poll cycle a few milliseconds later takes 3 or 4.
+
+  License:  GNU General Public License v3.0
+*/
+#include "Touch_Hal.h"
+
+class TouchTrace {
+public:
+  static const uint8_t VERSION     = 1;
+  static const uint8_t HEADER_SIZE = 4;
+  static const char MAGIC[3];
+
+  static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+  static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+};
+
+/*
+ * Backend decorator that forwards to another backend and records every conversion
+ */
+class TouchTraceRecorder : public TouchHal {
+public:
+  /**
+   * @param hal Backend doing the real work, e.g. an ArduinoTouchHal. Must outlive this object.
+   * @param out Destination of the trace; call begin() before the first conversion.
+   */
+  TouchTraceRecorder(TouchHal *hal, Print &out)
+      : _hal(hal), _out(out) {}
+
+  void begin(void);   // write the header and restart delta encoding
+
+  // TouchHal
+  void setPinMode(uint8_t plate, uint8_t mode) override { _hal->setPinMode(plate, mode); }
+  void writePin(uint8_t plate, uint8_t level) override { _hal->writePin(plate, level); }
+  int readPin(uint8_t plate) override;
+  uint32_t millis(void) override { return _hal->millis(); }
+  uint32_t micros(void) override { return _hal->micros(); }
+  void delayMicroseconds(uint16_t us) override { _hal->delayMicroseconds(us); }
+  uint32_t cycles(void) override { return _hal->cycles(); }
+
+  uint32_t recorded = 0;   // number of conversions written since begin()
+
+protected:
+  void writeVarint(uint32_t v);
+
+  TouchHal *_hal;
+  Print &_out;
+  uint32_t _lastUs = 0;
+  int16_t _last[NUM_PLATES];
+};
+
+/*
+ * Backend that replays a recorded trace from memory
+ */
+class TouchTraceReplay : public TouchHal {
+public:
+  /**
+   * @param trace Bytes written by a TouchTraceRecorder, header included. Must outlive this object.
+   * @param size  Number of bytes in trace
+   */
+  TouchTraceReplay(const uint8_t *trace, size_t size) { load(trace, size); }
+
+  // start over with another trace; returns false if the header is not a supported trace
+  bool load(const uint8_t *trace, size_t size);
+
+  bool finished(void) const { return _next == nullptr; }   // all conversions replayed, or stopped
+  bool diverged(void) const { return _diverged; }          // screen asked for a plate not recorded
+
+  // TouchHal
+  void setPinMode(uint8_t, uint8_t) override {}
+  void writePin(uint8_t, uint8_t) override {}
+  int readPin(uint8_t plate) override;
+
+  // The clock reads the time of the last replayed conversion. Asked again before
+  // another conversion, it jumps to the time of the next recorded one, so scheduling
+  // code that is waiting sees that just enough time has passed to take the next sample.
+  // Conversions take no time in replay, so dutyCyclePermille() reads 0.
+  uint32_t millis(void) override { return _nowUs / 1000; }
+  uint32_t micros(void) override {
+    if (_waiting) {
+      return _nowUs + _nextDeltaUs;
+    }
+    _waiting = true;
+    return _nowUs;
+  }
+  void delayMicroseconds(uint16_t) override {}
+  uint32_t cycles(void) override { return ::micros(); }
+
+  uint32_t replayed = 0;   // number of conversions returned since load()
+
+protected:
+  bool readVarint(uint32_t *v);
+  void fetch(void);   // decode the time of the next record
+
+  const uint8_t *_next = nullptr;   // next unread byte, nullptr when finished
+  const uint8_t *_end  = nullptr;
+  uint32_t _nowUs       = 0;
+  uint32_t _nextDeltaUs = 0;
+  bool _waiting         = true;   // micros() was read since the last conversion
+  bool _diverged        = false;
+  int16_t _last[NUM_PLATES];
+};
+
+/*
+ * Print that collects a trace in a caller-supplied buffer, for replaying it without a host
+ */
+class TouchTraceBuffer : public Print {
+public:
+  TouchTraceBuffer(uint8_t *buffer, size_t capacity)
+      : _buffer(buffer), _capacity(capacity) {}
+
+  size_t write(uint8_t b) override {
+    if (_size >= _capacity) {
+      overflow = true;
+      return 0;
+    }
+    _buffer[_size++] = b;
+    return 1;
+  }
+  using Print::write;
+
+  const uint8_t *data(void) const { return _buffer; }
+  size_t size(void) const { return _size; }
+  void clear(void) {
+    _size    = 0;
+    overflow = false;
+  }
+
+  bool overflow = false;   // some bytes did not fit
+
+protected:
+  uint8_t *_buffer;
+  size_t _capacity;
+  size_t _size = 0;
+};
@@ -49,7 +49,6 @@
 
 #include <Resistive_Touch_Screen.h>   // https://github.com/barry-ha/Resistive_Touch_Screen
 #include <Adafruit_ILI9341.h>         // TFT color display library
-#include <TouchScreen.h>              // Adafruit / Adafruit_Touchscreen library
 #include <elapsedMillis.h>            // Scheduling intervals in main loop
 #include "TextField.h"                // Helper for showing text on TFT display
 
@@ -60,18 +59,17 @@
 #define PIN_YM 9    // Touchscreen Y- can be a digital pin
 
 // ---------- Touch Screen configuration
-#define XP_XM_OHMS 310             // Resistance in ohms between X+ and X- to calibrate touch pressure
-                                   // measure this with an ohmmeter while device is turned off
-#define X_MIN_OHMS           150   // Default: Expected range on touchscreen's X-axis readings
+#define XP_XM_OHMS 310              // Resistance in ohms between X+ and X- to calibrate touch pressure
+                                    // measure this with an ohmmeter while device is turned off
+#define X_MIN_OHMS           150    // Default: Expected range on touchscreen's X-axis readings
 #define X_MAX_OHMS           900
-#define Y_MIN_OHMS           100   // Default: Expected range on touchscreen's Y-axis readings
+#define Y_MIN_OHMS           100    // Default: Expected range on touchscreen's Y-axis readings
 #define Y_MAX_OHMS           900
-#define START_TOUCH_PRESSURE 200   // Minimum pressure threshold considered start of "press"
-#define END_TOUCH_PRESSURE   50    // Maximum pressure threshold required before end of "press"
+#define START_TOUCH_PRESSURE 700    // With XP_XM_OHMS set, touch resistance in ohms below which a "press" starts
+#define END_TOUCH_PRESSURE   1200   // and above which it ends
 
 // ---------- Constructor
-Resistive_Touch_Screen tsn(PIN_XP, PIN_YP, PIN_XM, PIN_YM, XP_XM_OHMS);   // For single-point touches:
-TouchScreen ts(PIN_XP, PIN_YP, PIN_XM, PIN_YM, XP_XM_OHMS);               // For continuous touch information
+Resistive_Touch_Screen tsn(PIN_XP, PIN_YP, PIN_XM, PIN_YM, XP_XM_OHMS);   // For touches and continuous touch information
 
 // ------- Identity for splash screen and console --------
 #define PROGRAM_NAME "Touchscreen Calibrator"
@@ -261,11 +259,13 @@ elapsedMillis refreshTimer;
 void loop() {
 
   // if the the screen was touched, show where
-  ScreenPoint screen;
-  if (tsn.newScreenTap(&screen, tft.getRotation())) {
-
-    const int radius = 1;
-    tft.fillCircle(screen.x, screen.y, radius, ILI9341_RED);
+  // the event stream and the raw readings below come from the same measurements
+  TouchEvent event;
+  if (tsn.nextTouchEvent(&event, tft.getRotation())) {
+    if (event.type == TouchEvent::DOWN) {
+      const int radius = 1;
+      tft.fillCircle(event.point.x, event.point.y, radius, ILI9341_RED);
+    }
   }
 
   // continuously update the "touch" location and pressure
@@ -273,7 +273,7 @@ void loop() {
   if (refreshTimer > 200) {
     refreshTimer = 0;
 
-    TSPoint p = ts.getPoint();
+    PressPoint p = tsn.lastSample();
     updateScreen(p);
   }
 }
@@ -27,8 +27,8 @@
                          // Adafruit suggests entering resistance in ohms between
                          // X+ and X- to calibrate touch pressure, as measured
                          // with an ohmmeter while device is turned off.
-                         // However, if you set XP_XM_OHMS to non-zero, you might get
-                         // wild +/- 16-bit readings like I did. Run this "scope" to find out.
+                         // If you set XP_XM_OHMS to non-zero, Z is the touch resistance
+                         // in ohms instead, which falls as you press harder.
 #define X_MIN_OHMS 150   // Default: Expected range on touchscreen's X-axis readings
 #define X_MAX_OHMS 900
 #define Y_MIN_OHMS 100   // Default: Expected range on touchscreen's Y-axis readings
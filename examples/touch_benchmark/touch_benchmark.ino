@@ -0,0 +1,401 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     touch_benchmark.ino
+
+  Purpose:  Measure the cost of the touch acquisition pipeline, as a baseline
+            before and after performance work.
+
+            Each benchmark runs one operation many times against SimulatedTouchPanel,
+            so no touchscreen is needed, and reports:
+              ns/op   - elapsed time per operation, from the board's micros()
+              hal/op  - calls into the TouchHal backend (pinMode + write + read) per operation
+
+            The library does not allocate memory and every object here is static.
+            The host build checks that: it counts heap allocations while the sketch
+            runs and prints the total after the results.
+
+            Configurations cover oversampling factor and reducer, screen orientation,
+            and calibrated vs uncalibrated mapping, with and without a correction grid
+            or lookup tables, whose size in bytes is part of the row name.
+            nextTouchEvent() is timed with each setSmoothing() mode, and newScreenTap()
+            with tap validation on and off, since validation only applies to taps.
+            Gesture classification is timed per touch event, and
+            hit testing with TouchHitIndex against a linear scan of 10, 50 and 200 controls.
+
+            The pin work of getPoint() and newScreenTap() is also counted per backend:
+            each setPinMode() or writePin() is one pinMode() or digitalWrite() with
+            ArduinoTouchHal, and one virtual call. PortTouchHal switches all four
+            plates of a phase with one drivePhase() call and a few PORT register
+            writes; the host build counts those writes on a mock of the registers
+            (extras/host/Mock_Port.h), and a board shows "-". On SAMD boards, define
+            BENCH_HARDWARE to also time getPoint() through those two backends, with
+            the panel wired as below.
+
+            Results go to Serial once, at startup. Run it on the board you care
+            about; numbers from different CPUs are not comparable. The host build
+            (CMakeLists.txt in the library folder) also compiles this sketch as
+            the touch_benchmark program, for a baseline on a desktop computer.
+            Public domain.
+*/
+
+#include <Resistive_Touch_Screen.h>   // https://github.com/barry-ha/Resistive_Touch_Screen
+#include <Touch_Simulator.h>          // simulated panel backend
+#include <Touch_Gestures.h>           // gesture recognizer
+#include <Touch_Hit_Index.h>          // hit-testing index for on-screen controls
+
+// ---------- Touch Screen pins, only used with BENCH_HARDWARE
+#define PIN_XP A3   // Touchscreen X+ can be a digital pin
+#define PIN_XM A4   // Touchscreen X- must be an analog pin, use "An" notation
+#define PIN_YP A5   // Touchscreen Y+ must be an analog pin, use "An" notation
+#define PIN_YM 9    // Touchscreen Y- can be a digital pin
+
+#define ITERATIONS 2000   // operations per benchmark
+
+// expose the protected mapping step so it can be timed on its own
+class BenchTouchScreen : public Resistive_Touch_Screen {
+public:
+  BenchTouchScreen(TouchHal *hal)
+      : Resistive_Touch_Screen(hal, 0) {}
+  using Resistive_Touch_Screen::mapTouchToScreen;
+};
+
+SimulatedTouchPanel panel;
+BenchTouchScreen tsn(&panel);
+BenchTouchScreen *active = &tsn;   // screen measured by opGetPoint() and opNewScreenTap()
+
+#if defined(RTS_MOCK_PORT)
+// PortTouchHal on the host's mock PORT registers, with the simulated panel behind the pins:
+// each phase is also applied to the panel, which supplies the conversions and the clock
+class SimulatedPortHal : public PortTouchHal {
+public:
+  SimulatedPortHal()
+      : PortTouchHal(PIN_XP, PIN_YP, PIN_XM, PIN_YM) {}
+
+  bool drivePhase(uint8_t phase, uint8_t from) override {
+    for (uint8_t plate = 0; plate < NUM_PLATES; plate++) {
+      panel.setPinMode(plate, (phaseOutputs(phase) & (1 << plate)) ? OUTPUT : INPUT);
+      panel.writePin(plate, (phaseHighs(phase) & (1 << plate)) ? HIGH : LOW);
+    }
+    return PortTouchHal::drivePhase(phase, from);
+  }
+  int readPin(uint8_t plate) override { return panel.readPin(plate); }
+  uint32_t millis(void) override { return panel.millis(); }
+  uint32_t micros(void) override { return panel.micros(); }
+  void delayMicroseconds(uint16_t us) override { panel.delayMicroseconds(us); }
+};
+SimulatedPortHal simulatedPortHal;
+BenchTouchScreen portTsn(&simulatedPortHal);   // screen whose PORT writes are counted
+#endif
+
+int orientation = 1;   // used by the mapping and tap benchmarks
+uint16_t filterSamples[TouchFilter::MAX_SAMPLES];
+uint8_t filterCount   = 1;
+uint8_t filterReducer = TouchFilter::MEDIAN;
+
+TouchHitIndex<200> hits;   // controls for the hit-testing benchmarks
+
+volatile int32_t sink;   // keeps the compiler from discarding results
+
+// ========== operations under test ============================
+void opGetPoint() {
+  TSPoint p = active->getPoint();
+  sink      = p.x + p.y + p.z;
+}
+
+void opNewScreenTap() {
+  // alternate press and release so every other call reports a tap
+  static bool pressed = false;
+  pressed             = !pressed;
+  if (pressed) {
+    panel.touch(512, 512);
+  } else {
+    panel.release();
+  }
+  ScreenPoint screen;
+  sink = active->newScreenTap(&screen, orientation);
+}
+
+void opNextTouchEvent() {
+  // a drag across the panel, one poll() phase per call, lifted for the last 16 calls of 256
+  static uint8_t step = 0;
+  step                = step + 1;
+  if (step < 240) {
+    panel.touch(200 + step * 2, 512);
+  } else {
+    panel.release();
+  }
+  TouchEvent event;
+  sink = tsn.nextTouchEvent(&event, orientation);
+}
+
+void opMapTouchToScreen() {
+  static int16_t x = 0;
+  x                = (x + 37) & 1023;
+  ScreenPoint screen;
+  tsn.mapTouchToScreen(PressPoint(x, 1023 - x, 300), &screen, orientation);
+  sink = screen.x + screen.y;
+}
+
+void opFilter() {
+  // refill each time, since reducing sorts the buffer in place
+  for (int ii = 0; ii < filterCount; ii++) {
+    filterSamples[ii] = (ii * 389) & 1023;
+  }
+  sink = TouchFilter::reduce(filterSamples, filterCount, filterReducer);
+}
+
+void opGesture() {
+  // one event per call: a swipe of DOWN, 8 MOVEs and UP, 10 ms apart, repeated
+  static TouchGestureRecognizer gestures;
+  static uint32_t ms  = 0;
+  static uint8_t step = 0;
+  TouchEvent event;
+  event.type  = (step == 0) ? TouchEvent::DOWN : (step == 9) ? TouchEvent::UP : TouchEvent::MOVE;
+  event.point = ScreenPoint(20 + step * 30, 120, 300);
+  event.ms    = ms;
+  TouchGesture gesture;
+  sink = gestures.feed(event, &gesture) + gestures.poll(ms, &gesture);
+  ms   = ms + 10;
+  step = (step + 1) % 10;
+}
+
+// fill the screen with a grid of n equal controls, with gaps between them
+void layoutControls(uint16_t n) {
+  uint16_t cols = 1;
+  while (cols * cols < n) {
+    cols++;
+  }
+  uint16_t rows = (n + cols - 1) / cols;
+  hits.begin(320, 240);
+  for (uint16_t ii = 0; ii < n; ii++) {
+    int16_t w = 320 / cols;
+    int16_t h = 240 / rows;
+    hits.add(ii, (ii % cols) * w + 1, (ii / cols) * h + 1, w - 2, h - 2);
+  }
+  hits.build();
+}
+
+TSPoint nextHitPoint() {
+  static uint16_t ii = 0;
+  ii                 = (ii + 1) & 1023;
+  return TSPoint((ii * 37) % 321, (ii * 53) % 241, 0);
+}
+
+void opFindIndexed() {
+  sink = hits.find(nextHitPoint());
+}
+
+void opFindLinear() {
+  sink = hits.findLinear(nextHitPoint());
+}
+
+// ========== benchmark runner =================================
+void printHeader(const char *title) {
+  Serial.println();
+  Serial.println(title);
+  Serial.println("  benchmark                      ns/op  hal/op");
+}
+
+void runBenchmark(const char *name, void (*op)(), TouchHal *hal = &panel) {
+  op();   // warm up: fill the pin-state cache and build the transform
+  panel.resetCounters();
+
+  uint32_t start = micros();
+  for (int ii = 0; ii < ITERATIONS; ii++) {
+    op();
+  }
+  uint32_t elapsed = micros() - start;
+
+  uint32_t nsPerOp = (uint32_t)((uint64_t)elapsed * 1000 / ITERATIONS);
+  char temp[96];
+  if (hal == &panel) {
+    uint32_t calls = panel.pinModeCalls + panel.writeCalls + panel.readCalls;
+    snprintf(temp, sizeof(temp), "  %-28s %7lu  %6.2f",
+             name, (unsigned long)nsPerOp, (double)calls / ITERATIONS);
+  } else {
+    snprintf(temp, sizeof(temp), "  %-28s %7lu       -", name, (unsigned long)nsPerOp);
+  }
+  Serial.println(temp);
+}
+
+// run op the same way, forgetting the pin states before each call if the pins are shared
+void repeatOp(void (*op)(), bool sharedPins) {
+  active->resetPinCache();   // the panel's pins were last set through the other screen
+  op();                      // warm up: fill the pin-state cache and build the transform
+  panel.resetCounters();
+#if defined(RTS_MOCK_PORT)
+  Port::writes = 0;
+#endif
+  for (int ii = 0; ii < ITERATIONS; ii++) {
+    if (sharedPins) {
+      active->resetPinCache();
+    }
+    op();
+  }
+}
+
+// same oversampling on the screens of every backend
+void setPinWorkOversampling(uint8_t xy_samples, uint8_t z_samples) {
+  tsn.setOversampling(xy_samples, z_samples);
+#if defined(RTS_MOCK_PORT)
+  portTsn.setOversampling(xy_samples, z_samples);
+#endif
+}
+
+// count the pin work of one operation through each backend
+void countPinWork(const char *name, void (*op)(), bool sharedPins) {
+  repeatOp(op, sharedPins);
+  double modes  = (double)panel.pinModeCalls / ITERATIONS;
+  double writes = (double)panel.writeCalls / ITERATIONS;
+  double reads  = (double)panel.readCalls / ITERATIONS;
+  double clocks = (double)panel.clockCalls / ITERATIONS;
+
+  char port[8] = "      -";
+#if defined(RTS_MOCK_PORT)
+  active = &portTsn;
+  repeatOp(op, sharedPins);
+  snprintf(port, sizeof(port), "%7.2f", (double)Port::writes / ITERATIONS);
+  active = &tsn;
+#endif
+
+  char temp[96];
+  snprintf(temp, sizeof(temp), "  %-28s %7.2f %s %7.2f %7.2f %7.2f",
+           name, modes + writes, port, reads, clocks, modes + writes + reads + clocks);
+  Serial.println(temp);
+}
+
+//=========== setup ============================================
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(10);   // wait for USB serial to connect
+  }
+  Serial.println("Resistive_Touch_Screen benchmark");
+
+  tsn.setScreenSize(320, 240);
+  panel.touch(512, 512);
+  panel.setNoise(4);
+
+  const char *reducerNames[] = {"median", "trimmed", "minmax"};
+  char name[40];
+
+  // ----- acquisition, by oversampling factor and reducer
+  printHeader("getPoint() by oversampling");
+  tsn.setOversampling(1, 1);
+  runBenchmark("xy=1 z=1", opGetPoint);   // the reducer makes no difference to a single sample
+  for (uint8_t reducer = TouchFilter::MEDIAN; reducer <= TouchFilter::MINMAX_MEAN; reducer++) {
+    for (uint8_t samples = 3; samples <= TouchFilter::MAX_SAMPLES; samples += 2) {
+      tsn.setOversampling(samples, 3, reducer);
+      snprintf(name, sizeof(name), "xy=%d z=3 %s", samples, reducerNames[reducer]);
+      runBenchmark(name, opGetPoint);
+    }
+  }
+  tsn.setOversampling(1, 1);
+
+  // ----- pin work by backend, from the simulator's call counters and the mock PORT registers
+  setPinWorkOversampling(1, 1);
+  Serial.println();
+  Serial.println("Pin work per call by backend");
+  Serial.println("                               Arduino    PORT                 virtual");
+  Serial.println("  benchmark                      calls  writes   reads   clock   calls");
+  countPinWork("getPoint() xy=1 z=1", opGetPoint, false);
+  countPinWork("  pins shared with TFT", opGetPoint, true);
+  setPinWorkOversampling(5, 3);
+  countPinWork("getPoint() xy=5 z=3", opGetPoint, false);
+  setPinWorkOversampling(1, 1);
+  countPinWork("newScreenTap()", opNewScreenTap, false);
+  countPinWork("  pins shared with TFT", opNewScreenTap, true);
+
+  // ----- edge detection, including the mapping step on each tap
+  printHeader("newScreenTap() by orientation");
+  for (orientation = 0; orientation < 4; orientation++) {
+    snprintf(name, sizeof(name), "rotation %d", orientation);
+    runBenchmark(name, opNewScreenTap);
+  }
+
+  // ----- event stream by smoothing mode, and taps by validation
+  printHeader("nextTouchEvent() by smoothing");
+  const char *smoothingNames[] = {"off", "IIR", "One-Euro"};
+  for (uint8_t mode = TouchSmoother::OFF; mode <= TouchSmoother::ONE_EURO; mode++) {
+    tsn.setSmoothing(mode);
+    snprintf(name, sizeof(name), "smoothing %s", smoothingNames[mode]);
+    runBenchmark(name, opNextTouchEvent);
+  }
+  tsn.setSmoothing(TouchSmoother::OFF);
+  panel.touch(512, 512);
+
+  printHeader("newScreenTap() by tap validation");
+  runBenchmark("validation on", opNewScreenTap);   // default, 20 counts and 3 retries
+  tsn.setTapValidation(0, 0);
+  runBenchmark("validation off", opNewScreenTap);
+  tsn.setTapValidation(20, 3);
+
+  // ----- mapping alone, uncalibrated vs calibrated
+  printHeader("mapTouchToScreen()");
+  for (orientation = 0; orientation < 4; orientation++) {
+    snprintf(name, sizeof(name), "range, rotation %d", orientation);
+    runBenchmark(name, opMapTouchToScreen);
+  }
+  orientation = 1;
+  static int16_t xTable[1024 + 1], yTable[1024 + 1];
+  for (uint16_t entries = 1024; entries >= 64; entries /= 4) {
+    tsn.setLookupTables(xTable, yTable, entries);
+    snprintf(name, sizeof(name), "range, %d entries %d B", entries, (int)(2 * (entries + 1) * sizeof(int16_t)));
+    runBenchmark(name, opMapTouchToScreen);
+  }
+  tsn.setLookupTables(nullptr, nullptr, 0);
+  TouchMatrix matrix;   // plain scaling, 1024 touch units to 320x240 pixels
+  matrix.a = (int32_t)(320L << TouchMatrix::FRACTION_BITS) / 1024;
+  matrix.e = (int32_t)(240L << TouchMatrix::FRACTION_BITS) / 1024;
+  tsn.setCalibration(matrix, orientation);
+  runBenchmark("calibrated, rotation 1", opMapTouchToScreen);
+  static TouchCorrectionGrid grid;   // all-zero offsets cost the same as real ones
+  tsn.setCorrectionGrid(&grid, orientation);
+  runBenchmark("calibrated + grid", opMapTouchToScreen);
+  tsn.setCorrectionGrid(nullptr, orientation);
+  tsn.clearCalibration();
+
+  // ----- gesture classification, per event
+  printHeader("TouchGestureRecognizer");
+  runBenchmark("feed() + poll() per event", opGesture);
+
+  // ----- hit testing, index vs linear scan
+  printHeader("TouchHitIndex::find()");
+  const uint16_t layouts[] = {10, 50, 200};
+  for (uint16_t n : layouts) {
+    layoutControls(n);
+    snprintf(name, sizeof(name), "%d controls, index", n);
+    runBenchmark(name, opFindIndexed);
+    snprintf(name, sizeof(name), "%d controls, linear scan", n);
+    runBenchmark(name, opFindLinear);
+  }
+
+  // ----- filters alone
+  printHeader("TouchFilter::reduce()");
+  for (filterReducer = TouchFilter::MEDIAN; filterReducer <= TouchFilter::MINMAX_MEAN; filterReducer++) {
+    for (filterCount = 3; filterCount <= TouchFilter::MAX_SAMPLES; filterCount += 2) {
+      snprintf(name, sizeof(name), "n=%d %s", filterCount, reducerNames[filterReducer]);
+      runBenchmark(name, opFilter);
+    }
+  }
+
+#if defined(ARDUINO_ARCH_SAMD) && defined(BENCH_HARDWARE)
+  // ----- pin-based backends on real hardware
+  printHeader("getPoint() by backend");
+  static ArduinoTouchHal arduinoHal(PIN_XP, PIN_YP, PIN_XM, PIN_YM);
+  static PortTouchHal portHal(PIN_XP, PIN_YP, PIN_XM, PIN_YM);
+  static BenchTouchScreen arduinoScreen(&arduinoHal);
+  static BenchTouchScreen portScreen(&portHal);
+  active = &arduinoScreen;
+  runBenchmark("ArduinoTouchHal", opGetPoint, &arduinoHal);
+  active = &portScreen;
+  runBenchmark("PortTouchHal", opGetPoint, &portHal);
+  active = &tsn;
+#endif
+
+  Serial.println();
+  Serial.println("Done");
+}
+
+void loop() {
+}
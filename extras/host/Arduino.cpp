@@ -0,0 +1,88 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     Arduino.cpp (host shim)
+
+  Purpose:  Host implementation of the Arduino functions declared in extras/host/Arduino.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include <Arduino.h>
+#include <time.h>
+
+HardwareSerial Serial;
+
+static uint64_t monotonicMicros(void) {
+  static uint64_t start = 0;
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t us = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+  if (start == 0) {
+    start = us;   // count from first use, like a board counts from reset
+  }
+  return us - start;
+}
+
+unsigned long millis(void) { return (unsigned long)(monotonicMicros() / 1000); }
+unsigned long micros(void) { return (unsigned long)monotonicMicros(); }
+
+void delay(unsigned long ms) { delayMicroseconds(ms * 1000); }
+void delayMicroseconds(unsigned int us) {
+  uint64_t until = monotonicMicros() + us;
+  while (monotonicMicros() < until) {
+  }
+}
+
+// there are no pins on the host; use a TouchHal backend such as SimulatedTouchPanel
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int analogRead(uint8_t) { return 0; }
+
+long random(long howbig) { return howbig ? rand() % howbig : 0; }
+long random(long howsmall, long howbig) { return howsmall + random(howbig - howsmall); }
+
+// ---------- Mock_Port.h
+Port mockPort;
+uint32_t Port::writes = 0;
+
+PortGroup::PortGroup() {
+  for (uint8_t pin = 0; pin < 32; pin++) {
+    PINCFG[pin].reg.state = &pincfg[pin];
+    PINCFG[pin].reg.op    = MockRegister::STORE;
+  }
+}
+
+MockRegister::Reg &MockRegister::Reg::operator=(uint32_t value) {
+  Port::writes++;
+  switch (op) {
+  case SET:
+    *state |= value;
+    break;
+  case CLEAR:
+    *state &= ~value;
+    break;
+  case STORE:
+    *state = value;
+    break;
+  case WRCONFIG:
+    if (value & PORT_WRCONFIG_WRPINCFG) {
+      uint8_t first = (value & PORT_WRCONFIG_HWSEL) ? 16 : 0;
+      for (uint8_t bit = 0; bit < 16; bit++) {
+        if (value & (1ul << bit)) {
+          state[first + bit] = (value >> 16) & (PORT_PINCFG_PMUXEN | PORT_PINCFG_INEN | PORT_PINCFG_PULLEN | PORT_PINCFG_DRVSTR);
+        }
+      }
+    }
+    break;
+  }
+  return *this;
+}
+
+// pin n is bit n of group n % 2
+#define MOCK_PIN(n) {(n) % 2, (n)}
+const PinDescription g_APinDescription[32] = {
+    MOCK_PIN(0), MOCK_PIN(1), MOCK_PIN(2), MOCK_PIN(3), MOCK_PIN(4), MOCK_PIN(5), MOCK_PIN(6), MOCK_PIN(7),
+    MOCK_PIN(8), MOCK_PIN(9), MOCK_PIN(10), MOCK_PIN(11), MOCK_PIN(12), MOCK_PIN(13), MOCK_PIN(14), MOCK_PIN(15),
+    MOCK_PIN(16), MOCK_PIN(17), MOCK_PIN(18), MOCK_PIN(19), MOCK_PIN(20), MOCK_PIN(21), MOCK_PIN(22), MOCK_PIN(23),
+    MOCK_PIN(24), MOCK_PIN(25), MOCK_PIN(26), MOCK_PIN(27), MOCK_PIN(28), MOCK_PIN(29), MOCK_PIN(30), MOCK_PIN(31),
+};
@@ -0,0 +1,92 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Arduino.h (host shim)
+
+  Purpose:  The small part of the Arduino core this library uses, so that it builds
+            and runs on a desktop computer with a normal C++ toolchain. See the
+            CMakeLists.txt in the library's root folder.
+
+            Serial prints to stdout. The clock is the host's monotonic clock, so
+            timing and instrumentation give real numbers. The pin functions do
+            nothing; use a TouchHal backend such as SimulatedTouchPanel instead.
+            Mock_Port.h adds the SAMD PORT registers, so PortTouchHal builds too.
+
+            Not used by the Arduino IDE, which ignores the extras folder.
+
+  License:  GNU General Public License v3.0
+*/
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INPUT  0x0
+#define OUTPUT 0x1
+#define LOW    0x0
+#define HIGH   0x1
+#define DEC    10
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int analogRead(uint8_t pin);
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v, int base = DEC) { return printNumber("%ld", v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printNumber("%lu", v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t println(void) { return print("\n"); }
+  template <typename T>
+  size_t println(T v) { return print(v) + println(); }
+
+protected:
+  template <typename T>
+  size_t printNumber(const char *format, T v, int base) {
+    char temp[24];
+    snprintf(temp, sizeof(temp), (base == 16) ? "%lx" : format, v);
+    return print(temp);
+  }
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#include "Mock_Port.h"   // SAMD PORT registers, for PortTouchHal
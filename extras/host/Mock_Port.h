@@ -0,0 +1,69 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Mock_Port.h (host shim)
+
+  Purpose:  The SAMD PORT registers that PortTouchHal writes, so that it builds and
+            runs on the host too. Each register write is applied to the pin state it
+            stands for, and counted in Port::writes for the tests and the benchmark.
+
+            Pin n of g_APinDescription is bit n of port group n % 2, so the touch
+            pins of the examples (A3, A4, A5 and 9) use both groups, and both halves
+            of a group.
+
+            Not used by the Arduino IDE, which ignores the extras folder.
+
+  License:  GNU General Public License v3.0
+*/
+#include <stdint.h>
+
+#define RTS_MOCK_PORT   // Touch_Hal.h builds PortTouchHal against these
+
+#define PORT_PINCFG_PMUXEN           (1u << 0)
+#define PORT_PINCFG_INEN             (1u << 1)
+#define PORT_PINCFG_PULLEN           (1u << 2)
+#define PORT_PINCFG_DRVSTR           (1u << 6)
+#define PORT_WRCONFIG_PINMASK(value) ((uint32_t)(value) & 0xFFFF)
+#define PORT_WRCONFIG_PMUXEN         (1ul << 16)
+#define PORT_WRCONFIG_INEN           (1ul << 17)
+#define PORT_WRCONFIG_PULLEN         (1ul << 18)
+#define PORT_WRCONFIG_DRVSTR         (1ul << 22)
+#define PORT_WRCONFIG_WRPINCFG       (1ul << 30)
+#define PORT_WRCONFIG_HWSEL          (1ul << 31)
+
+// A write-only register, as in reg = value. The write is counted and changes *state:
+// sets or clears the bits written, stores the value, or for WRCONFIG writes the PINCFG
+// of each pin in the mask, with state pointing at the PINCFG of pin 0.
+struct MockRegister {
+  enum Op : uint8_t { SET, CLEAR, STORE, WRCONFIG };
+  struct Reg {
+    uint32_t *state;
+    Op op;
+    Reg &operator=(uint32_t value);
+  } reg;
+};
+
+struct PortGroup {
+  PortGroup();
+  uint32_t dir        = 0;    // DIR, 1 = output
+  uint32_t out        = 0;    // OUT, 1 = high
+  uint32_t pincfg[32] = {};   // PINCFG of each pin
+  MockRegister DIRSET{{&dir, MockRegister::SET}};
+  MockRegister DIRCLR{{&dir, MockRegister::CLEAR}};
+  MockRegister OUTSET{{&out, MockRegister::SET}};
+  MockRegister OUTCLR{{&out, MockRegister::CLEAR}};
+  MockRegister WRCONFIG{{pincfg, MockRegister::WRCONFIG}};
+  MockRegister PINCFG[32];
+};
+
+struct Port {
+  PortGroup Group[2];
+  static uint32_t writes;   // register writes since the last reset, by any group
+};
+extern Port mockPort;
+#define PORT (&mockPort)
+
+struct PinDescription {
+  uint8_t ulPort;   // index into PORT->Group[]
+  uint32_t ulPin;   // bit within the group
+};
+extern const PinDescription g_APinDescription[];
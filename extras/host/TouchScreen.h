@@ -0,0 +1,21 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     TouchScreen.h (host shim)
+
+  Purpose:  TSPoint from Adafruit_TouchScreen, the only part of it this library uses,
+            for building on a desktop computer. See extras/host/Arduino.h.
+
+  License:  GNU General Public License v3.0
+*/
+#include <stdint.h>
+
+class TSPoint {
+public:
+  TSPoint(void) : x(0), y(0), z(0) {}
+  TSPoint(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+
+  bool operator==(TSPoint p) { return ((p.x == x) && (p.y == y) && (p.z == z)); }
+  bool operator!=(TSPoint p) { return ((p.x != x) || (p.y != y) || (p.z != z)); }
+
+  int16_t x, y, z;
+};
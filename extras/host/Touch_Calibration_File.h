@@ -0,0 +1,46 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     Touch_Calibration_File.h (host only)
+
+  Purpose:  Keep a saved calibration in a file, the desktop counterpart of the flash or
+            EEPROM a sketch would use. The file holds exactly the blob written by
+            saveCalibration(), so a file saved here can be copied to a board and back.
+
+  Example:
+            if (!TouchCalibrationFile::load(tsn, "touch.cal")) {
+              calibrate();
+              TouchCalibrationFile::save(tsn, "touch.cal");
+            }
+
+  License:  GNU General Public License v3.0
+*/
+#include <Resistive_Touch_Screen.h>
+#include <stdio.h>
+
+class TouchCalibrationFile {
+public:
+  // write the current calibration; false if the file cannot be written
+  static bool save(const Resistive_Touch_Screen &tsn, const char *path) {
+    uint8_t blob[sizeof(TouchCalibrationRecord)];
+    size_t size = tsn.saveCalibration(blob, sizeof(blob));
+    FILE *file  = fopen(path, "wb");
+    if (file == nullptr) {
+      return false;
+    }
+    bool written = fwrite(blob, 1, size, file) == size;
+    return (fclose(file) == 0) && written;
+  }
+
+  // apply a saved calibration; false, with nothing changed, if the file is missing,
+  // short or not a valid record
+  static bool load(Resistive_Touch_Screen &tsn, const char *path) {
+    uint8_t blob[sizeof(TouchCalibrationRecord)];
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+      return false;
+    }
+    size_t size = fread(blob, 1, sizeof(blob), file);
+    fclose(file);
+    return tsn.loadCalibration(blob, size);
+  }
+};
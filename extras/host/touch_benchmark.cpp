@@ -0,0 +1,32 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     touch_benchmark.cpp
+
+  Purpose:  Run examples/touch_benchmark on the host, where setup() prints the results
+            to stdout. Also counts heap allocations made while it runs, which the sketch
+            itself cannot see.
+
+  License:  GNU General Public License v3.0
+*/
+
+#include <new>
+#include "../../examples/touch_benchmark/touch_benchmark.ino"
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+int main(void) {
+  setup();
+  printf("heap allocations: %lu\n", allocations);
+  return 0;
+}
@@ -0,0 +1,68 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     fixed_readings_hal.h
+
+  Purpose:  Shared by test_properties.cpp and the fuzz target: a backend whose plates
+            read whatever the test sets, a screen that exposes the protected steps,
+            and the tap property both of them check.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Resistive_Touch_Screen.h>
+
+// Backend for the tap properties: each plate reads a fixed value until the test picks another
+class FixedReadingsHal : public TouchHal {
+public:
+  int reading[NUM_PLATES] = {0, 0, 0, 0};
+
+  void setPinMode(uint8_t, uint8_t) override {}
+  void writePin(uint8_t, uint8_t) override {}
+  int readPin(uint8_t plate) override { return reading[plate]; }
+  void delayMicroseconds(uint16_t) override {}
+};
+
+// Sets the default thresholds itself, so the checks know them
+class ProbeScreen : public Resistive_Touch_Screen {
+public:
+  ProbeScreen(TouchHal *hal, uint16_t rx)
+      : Resistive_Touch_Screen(hal, rx)
+      , start(rx ? 700 : 200)
+      , stop(rx ? 1200 : 50) {
+    setThreshhold(start, stop);
+  }
+  using Resistive_Touch_Screen::firmerThan;
+  using Resistive_Touch_Screen::isTouching;
+  using Resistive_Touch_Screen::lighterThan;
+  using Resistive_Touch_Screen::mapTouchToScreen;
+  using Resistive_Touch_Screen::pressure;
+
+  const uint16_t start;
+  const uint16_t stop;
+};
+
+// Follows the taps reported by newScreenTap() against the pressure of the fixed readings,
+// keeping its own copy of the isTouching() hysteresis: a tap needs a touch, and the end
+// of the previous touch since the last tap
+struct TapWatch {
+  int taps      = 0;
+  int releases  = 0;
+  bool touching = false;
+  bool released = true;
+
+  // call after each newScreenTap() or isTouching(); false if tap broke a property
+  bool check(ProbeScreen &tsn, bool tap) {
+    uint16_t pres_val = tsn.pressure();   // the readings have not changed, so this is what the call saw
+    touching          = touching ? !tsn.lighterThan(pres_val, tsn.stop) : tsn.firmerThan(pres_val, tsn.start);
+    if (!touching && !released) {
+      released = true;
+      releases++;
+    }
+    if (tap) {
+      bool ok  = touching && released;
+      released = false;
+      taps++;
+      return ok;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,60 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     fuzz_taps.cpp
+
+  Purpose:  libFuzzer target for tap detection. The input bytes set the plate readings
+            and interleave isTouching() with newScreenTap(); it traps if a tap comes
+            without a touch, or after another tap without a release between them.
+
+            Byte 0 picks the configuration: bit 0 pressure in ohms, bit 1 tap
+            validation off, bit 2 oversampling. Then each byte is an operation:
+              1ppxxxxx v  - plate p reads v, scaled to 0..1023
+              0xxxxoo1    - newScreenTap() in orientation o
+              0xxxxxx0    - isTouching()
+
+            cmake -S . -B fuzz -DCMAKE_CXX_COMPILER=clang++ -DRTS_FUZZ=ON
+            cmake --build fuzz --target touch_fuzz && fuzz/touch_fuzz
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "../fixed_readings_hal.h"
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  FixedReadingsHal hal;
+  ProbeScreen tsn(&hal, (data[0] & 1) ? 300 : 0);
+  if (data[0] & 2) {
+    tsn.setTapValidation(0, 0);
+  }
+  if (data[0] & 4) {
+    tsn.setOversampling(5, 3, TouchFilter::TRIMMED_MEAN);
+  }
+
+  TapWatch watch;
+  for (size_t ii = 1; ii < size; ii++) {
+    uint8_t op = data[ii];
+    if (op & 0x80) {
+      if (++ii == size) {
+        break;
+      }
+      hal.reading[(op >> 5) & 3] = (data[ii] << 2) | (data[ii] >> 6);   // 0 and 1023 both reachable
+      continue;
+    }
+    bool tap = false;
+    if (op & 1) {
+      ScreenPoint screen;
+      tap = tsn.newScreenTap(&screen, (op >> 1) & 3);
+    } else {
+      tsn.isTouching();
+    }
+    if (!watch.check(tsn, tap)) {
+      __builtin_trap();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once   // Please format this file with clang before check-in to GitHub
+/*
+  File:     test.h
+
+  Purpose:  Minimal test registry for the host test runner, touch_tests.
+
+            Each TEST() registers itself before main() runs, so a new test file
+            only needs to be added to CMakeLists.txt. A failed CHECK() prints its
+            file, line and condition, and the test keeps going. touch_tests exits
+            with a non-zero code if any check failed.
+
+  License:  GNU General Public License v3.0
+*/
+#include <Arduino.h>
+
+typedef void (*TestFunction)(void);
+
+struct TestCase {
+  TestCase(const char *name, TestFunction function);
+  const char *name;
+  TestFunction function;
+  TestCase *next;
+};
+
+void testFailed(const char *file, int line, const char *condition);
+
+#define TEST(name)                               \
+  static void test_##name(void);                 \
+  static TestCase testCase_##name(#name, test_##name); \
+  static void test_##name(void)
+
+#define CHECK(condition)                             \
+  do {                                               \
+    if (!(condition)) {                              \
+      testFailed(__FILE__, __LINE__, #condition);    \
+    }                                                \
+  } while (0)
+
+#define CHECK_EQ(expected, actual) CHECK((expected) == (actual))
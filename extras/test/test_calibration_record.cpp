@@ -0,0 +1,86 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_calibration_record.cpp
+
+  Purpose:  A saved calibration loads back to the same bytes, in memory and through a
+            file, and a damaged or short blob is rejected without changing anything
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Touch_Calibration_File.h>
+#include <Touch_Simulator.h>
+#include <stdio.h>
+#include <string.h>
+
+static const size_t SIZE = sizeof(TouchCalibrationRecord);
+static const char *PATH  = "test_calibration_record.cal";
+
+// a screen with every field of the record away from its default
+static void calibrate(Resistive_Touch_Screen &tsn) {
+  tsn.setResistanceRange(130, 880, 95, 910, 290);
+  tsn.setThreshhold(180, 240);
+  TouchMatrix m;
+  m.a = 24117;
+  m.b = -310;
+  m.c = -3018221;
+  m.d = 402;
+  m.e = 25166;
+  m.f = -2241050;
+  tsn.setCalibration(m, 3);
+}
+
+TEST(calibration_save_load_save) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen saved(&panel, 300), loaded(&panel, 300);
+  calibrate(saved);
+  uint8_t first[SIZE], second[SIZE];
+  CHECK_EQ(SIZE, saved.saveCalibration(first, sizeof(first)));
+  CHECK(loaded.loadCalibration(first, sizeof(first)));
+  CHECK_EQ(SIZE, loaded.saveCalibration(second, sizeof(second)));
+  CHECK(memcmp(first, second, SIZE) == 0);
+  CHECK_EQ(0, saved.saveCalibration(second, SIZE - 1));   // too small to hold a record
+}
+
+TEST(calibration_rejects_damaged_blob) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen saved(&panel, 300), tsn(&panel, 300);
+  calibrate(saved);
+  uint8_t good[SIZE], blob[SIZE], before[SIZE], after[SIZE];
+  saved.saveCalibration(good, sizeof(good));
+  tsn.saveCalibration(before, sizeof(before));
+
+  // every single flipped bit, in the header, the fields and the CRC itself
+  for (size_t bit = 0; bit < SIZE * 8; bit++) {
+    memcpy(blob, good, SIZE);
+    blob[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    CHECK(!tsn.loadCalibration(blob, sizeof(blob)));
+  }
+  CHECK(!tsn.loadCalibration(good, SIZE - 1));
+  CHECK(!tsn.loadCalibration(nullptr, SIZE));
+  tsn.saveCalibration(after, sizeof(after));
+  CHECK(memcmp(before, after, SIZE) == 0);
+}
+
+TEST(calibration_file_backend) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen saved(&panel, 300), loaded(&panel, 300);
+  calibrate(saved);
+  uint8_t first[SIZE], second[SIZE];
+  saved.saveCalibration(first, sizeof(first));
+
+  CHECK(TouchCalibrationFile::save(saved, PATH));
+  CHECK(TouchCalibrationFile::load(loaded, PATH));
+  loaded.saveCalibration(second, sizeof(second));
+  CHECK(memcmp(first, second, SIZE) == 0);
+
+  // a truncated file, and a missing one
+  FILE *file = fopen(PATH, "wb");
+  CHECK(file != nullptr);
+  fwrite(first, 1, SIZE - 1, file);
+  fclose(file);
+  CHECK(!TouchCalibrationFile::load(loaded, PATH));
+  remove(PATH);
+  CHECK(!TouchCalibrationFile::load(loaded, PATH));
+}
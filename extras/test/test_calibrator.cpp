@@ -0,0 +1,110 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_calibrator.cpp
+
+  Purpose:  TouchCalibrator recovers a skewed, offset panel to within a pixel,
+            running the whole workflow against the simulated panel
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Touch_Calibrator.h>
+#include <Touch_Simulator.h>
+#include <math.h>
+#include <stdio.h>
+
+// where a screen pixel lies on the panel: offset, scaled, and skewed by the film
+static void panelAt(int16_t px, int16_t py, int16_t *x, int16_t *y) {
+  *x = (int16_t)lroundf(110 + 2.7f * px + 0.12f * py);
+  *y = (int16_t)lroundf(95 - 0.09f * px + 2.55f * py);
+}
+
+struct Operator {
+  ScreenPoint target;
+  uint8_t prompts = 0;
+};
+
+static void showTarget(uint8_t, ScreenPoint target, void *context) {
+  Operator *op = (Operator *)context;
+  op->target   = target;
+  op->prompts++;
+}
+
+// touch each target for 30 ms, then lift for 30 ms, polling every 100 us, until done
+static bool touchTargets(TouchCalibrator &calibrator, SimulatedTouchPanel &panel, Operator &op) {
+  bool done = false;
+  for (int touches = 0; touches < 10 && !done; touches++) {
+    int16_t x, y;
+    panelAt(op.target.x, op.target.y, &x, &y);
+    panel.touch(x, y);
+    for (int ii = 0; ii < 600 && !done; ii++) {
+      if (ii == 300) {
+        panel.release();
+      }
+      done = calibrator.update();
+      panel.advanceMicros(100);
+    }
+  }
+  return done;
+}
+
+TEST(calibrator_recovers_skew_and_offset) {
+  const uint16_t WIDTH = 240, HEIGHT = 320, ORIENTATION = 0;
+  SimulatedTouchPanel panel;
+  panel.setNoise(3);
+  Resistive_Touch_Screen tsn(&panel, 300);
+  tsn.setScreenSize(WIDTH, HEIGHT);
+  Operator op;
+  TouchCalibrator calibrator(tsn, showTarget, &op);
+
+  calibrator.begin(WIDTH, HEIGHT, ORIENTATION);
+  CHECK(touchTargets(calibrator, panel, op));
+  CHECK_EQ(TouchCalibrator::DONE, calibrator.state());
+  CHECK_EQ(5, op.prompts);
+  CHECK(calibrator.rmsErrorPixels() < 1);
+  printf("  fit error: rms %.3f, max %.3f pixels\n", calibrator.rmsErrorPixels(), calibrator.maxErrorPixels());
+
+  // taps mapped with the result land within a pixel of where they were aimed
+  TouchCalibrationRecord rec;
+  CHECK(calibrator.getRecord(&rec));
+  CHECK(tsn.setCalibrationRecord(rec));
+  panel.setNoise(0);
+  for (int16_t py = 20; py < HEIGHT; py += 70) {
+    for (int16_t px = 20; px < WIDTH; px += 50) {
+      int16_t x, y;
+      panelAt(px, py, &x, &y);
+      panel.touch(x, y);
+      ScreenPoint screen;
+      CHECK(tsn.newScreenTap(&screen, ORIENTATION));
+      CHECK(abs(screen.x - px) <= 1 && abs(screen.y - py) <= 1);
+      panel.release();
+      tsn.newScreenTap(&screen, ORIENTATION);
+    }
+  }
+}
+
+TEST(calibrator_needs_three_targets) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 300);
+  tsn.setScreenSize(240, 320);
+  Operator op;
+  TouchCalibrator calibrator(tsn, showTarget, &op);
+  const ScreenPoint targets[] = {{30, 40, 0}, {200, 60, 0}, {120, 280, 0}};
+
+  // too few to fit a matrix: rejected before anyone touches anything, defaults kept
+  CHECK(!calibrator.setTargets(nullptr, 3));
+  CHECK(!calibrator.setTargets(targets, 0));
+  CHECK(!calibrator.setTargets(targets, 2));
+  calibrator.begin(240, 320, 0);
+  CHECK_EQ(24, op.target.x);   // first default target, 10% in from the corner
+
+  // three are enough
+  CHECK(calibrator.setTargets(targets, 3));
+  op.prompts = 0;
+  calibrator.begin(240, 320, 0);
+  CHECK_EQ(30, op.target.x);
+  CHECK(touchTargets(calibrator, panel, op));
+  CHECK_EQ(3, op.prompts);
+  CHECK_EQ(TouchCalibrator::DONE, calibrator.state());
+}
@@ -0,0 +1,90 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_correction_grid.cpp
+
+  Purpose:  TouchCorrectionGrid takes out most of the error that an affine calibration
+            leaves on a simulated panel with pincushion distortion
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <math.h>
+#include <stdio.h>
+
+static const int16_t WIDTH = 240, HEIGHT = 320;
+static const float BULGE   = 18.0f;   // pixels the film pushes the corners outward, along each axis
+
+// where a screen pixel lies on the panel: pushed outward by the film, then scaled and offset
+static PressPoint panelAt(int16_t px, int16_t py) {
+  float u  = (px - WIDTH / 2.0f) / (WIDTH / 2.0f);   // -1..1 across the screen
+  float v  = (py - HEIGHT / 2.0f) / (HEIGHT / 2.0f);
+  float r2 = (u * u + v * v) / 2;                     // 1 in the corners
+  float x  = px + BULGE * u * r2;
+  float y  = py + BULGE * v * r2;
+  return PressPoint((int16_t)lroundf(110 + 2.7f * x), (int16_t)lroundf(95 + 2.55f * y), 0);
+}
+
+// tap the panel at screen locations inside the edges; error of the mapped taps in pixels
+static void measure(Resistive_Touch_Screen &tsn, SimulatedTouchPanel &panel, float *rms, float *worst) {
+  float sum = 0;
+  int n     = 0;
+  *worst    = 0;
+  for (int16_t py = 8; py <= HEIGHT - 8; py += 16) {
+    for (int16_t px = 8; px <= WIDTH - 8; px += 16) {
+      PressPoint p = panelAt(px, py);
+      panel.touch(p.x, p.y);
+      ScreenPoint screen;
+      CHECK(tsn.newScreenTap(&screen, 0));
+      panel.release();
+      tsn.newScreenTap(&screen, 0);
+
+      float dx = screen.x - px, dy = screen.y - py;
+      float e  = sqrtf(dx * dx + dy * dy);
+      sum += e * e;
+      *worst = (e > *worst) ? e : *worst;
+      n++;
+    }
+  }
+  *rms = sqrtf(sum / n);
+}
+
+TEST(correction_grid_on_nonlinear_panel) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 300);
+  tsn.setScreenSize(WIDTH, HEIGHT);
+
+  // least-squares affine fit to a 3x3 set of calibration touches
+  PressPoint touch[9];
+  ScreenPoint screen[9];
+  for (int ii = 0; ii < 9; ii++) {
+    screen[ii] = ScreenPoint(WIDTH / 10 + (ii % 3) * WIDTH * 4 / 10, HEIGHT / 10 + (ii / 3) * HEIGHT * 4 / 10, 0);
+    touch[ii]  = panelAt(screen[ii].x, screen[ii].y);
+  }
+  CHECK(tsn.setCalibration(touch, screen, 9, 0));
+  float affineRms, affineWorst;
+  measure(tsn, panel, &affineRms, &affineWorst);
+
+  // grid offsets measured against the unclamped affine result at each control point
+  TouchCorrectionGrid grid;
+  for (uint8_t row = 0; row < TouchCorrectionGrid::ROWS; row++) {
+    for (uint8_t col = 0; col < TouchCorrectionGrid::COLS; col++) {
+      int16_t px = col * WIDTH / (TouchCorrectionGrid::COLS - 1);
+      int16_t py = row * HEIGHT / (TouchCorrectionGrid::ROWS - 1);
+      TSPoint mapped;
+      tsn.getCalibration().apply(panelAt(px, py), &mapped);
+      grid.setOffset(col, row, px - mapped.x, py - mapped.y);
+    }
+  }
+  tsn.setCorrectionGrid(&grid, 0);
+  float gridRms, gridWorst;
+  measure(tsn, panel, &gridRms, &gridWorst);
+
+  printf("  affine: rms %.2f, worst %.2f pixels; with grid: rms %.2f, worst %.2f pixels\n",
+         affineRms, affineWorst, gridRms, gridWorst);
+  CHECK(affineWorst > 6);   // the distortion is there to correct
+  CHECK(gridRms < affineRms * 0.6f);
+  CHECK(gridWorst < affineWorst / 2);
+}
@@ -0,0 +1,206 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_gestures.cpp
+
+  Purpose:  TouchGestureRecognizer against recorded event sequences, and end to end
+            from a simulated panel through nextTouchEvent()
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Touch_Gestures.h>
+#include <Touch_Simulator.h>
+
+struct ScriptedEvent {
+  uint8_t type;
+  int16_t x, y;
+  uint32_t ms;
+};
+
+// Feed a sequence of events, calling poll() every millisecond in between like loop() would,
+// and collect the gestures reported. Returns the number of gestures.
+static int play(TouchGestureRecognizer &gestures, const ScriptedEvent *script, int count,
+                uint32_t end_ms, TouchGesture *found, int max_found) {
+  int n      = 0;
+  uint32_t t = script[0].ms;
+  for (int ii = 0; ii <= count; ii++) {
+    uint32_t until = (ii < count) ? script[ii].ms : end_ms;
+    for (; t < until; t++) {
+      if (n < max_found && gestures.poll(t, &found[n])) {
+        n++;
+      }
+    }
+    if (ii < count) {
+      TouchEvent event;
+      event.type  = script[ii].type;
+      event.point = ScreenPoint(script[ii].x, script[ii].y, 500);
+      event.ms    = script[ii].ms;
+      if (n < max_found && gestures.feed(event, &found[n])) {
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+TEST(gesture_tap) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 100, 100, 1000},
+      {TouchEvent::MOVE, 103, 98, 1040},   // within the tap slop
+      {TouchEvent::UP, 103, 98, 1080},
+  };
+  TouchGestureRecognizer gestures;
+  TouchGesture found[4];
+  CHECK_EQ(1, play(gestures, script, 3, 1500, found, 4));
+  CHECK_EQ(TouchGesture::TAP, found[0].type);
+  CHECK_EQ(100, found[0].point.x);
+  CHECK(found[0].ms > 1080u + gestures.doubleTapMs);   // held back until no second tap came
+}
+
+TEST(gesture_tap_at_once_without_double_tap) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 100, 100, 1000},
+      {TouchEvent::UP, 100, 100, 1080},
+  };
+  TouchGestureRecognizer gestures;
+  gestures.doubleTapMs = 0;
+  TouchGesture found[4];
+  CHECK_EQ(1, play(gestures, script, 2, 1081, found, 4));
+  CHECK_EQ(TouchGesture::TAP, found[0].type);
+  CHECK_EQ(1080u, found[0].ms);
+}
+
+TEST(gesture_double_tap) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 200, 150, 1000},
+      {TouchEvent::UP, 200, 150, 1070},
+      {TouchEvent::DOWN, 204, 147, 1180},
+      {TouchEvent::UP, 204, 147, 1250},
+  };
+  TouchGestureRecognizer gestures;
+  TouchGesture found[4];
+  CHECK_EQ(1, play(gestures, script, 4, 2000, found, 4));
+  CHECK_EQ(TouchGesture::DOUBLE_TAP, found[0].type);
+  CHECK_EQ(200, found[0].point.x);
+  CHECK_EQ(1250u, found[0].ms);
+}
+
+TEST(gesture_long_press_while_held) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 50, 60, 1000},
+      {TouchEvent::MOVE, 54, 60, 1300},
+      {TouchEvent::UP, 54, 60, 2500},
+  };
+  TouchGestureRecognizer gestures;
+  TouchGesture found[4];
+  CHECK_EQ(1, play(gestures, script, 3, 3000, found, 4));   // nothing more on lift
+  CHECK_EQ(TouchGesture::LONG_PRESS, found[0].type);
+  CHECK_EQ(1000u + gestures.longPressMs, found[0].ms);   // reported by poll(), while held
+  CHECK_EQ(50, found[0].point.x);
+}
+
+TEST(gesture_tap_then_long_press) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 80, 90, 1000},
+      {TouchEvent::UP, 80, 90, 1060},
+      {TouchEvent::DOWN, 82, 91, 1150},   // in time for a double-tap, but held
+      {TouchEvent::UP, 82, 91, 2500},
+  };
+  TouchGestureRecognizer gestures;
+  TouchGesture found[4];
+  CHECK_EQ(2, play(gestures, script, 4, 3000, found, 4));
+  CHECK_EQ(TouchGesture::TAP, found[0].type);
+  CHECK_EQ(80, found[0].point.x);
+  CHECK_EQ(TouchGesture::LONG_PRESS, found[1].type);
+  CHECK_EQ(82, found[1].point.x);
+  CHECK_EQ(1150u + gestures.longPressMs, found[1].ms);
+
+  // with a double-tap window longer than the long-press, the tap comes just before it
+  gestures.reset();
+  gestures.doubleTapMs = 1000;
+  CHECK_EQ(2, play(gestures, script, 4, 3000, found, 4));
+  CHECK_EQ(TouchGesture::TAP, found[0].type);
+  CHECK_EQ(1150u + gestures.longPressMs, found[0].ms);
+  CHECK_EQ(TouchGesture::LONG_PRESS, found[1].type);
+  CHECK_EQ(1151u + gestures.longPressMs, found[1].ms);
+}
+
+TEST(gesture_swipes) {
+  // direction of travel, and velocity from the history window in pixels per second
+  const struct {
+    int16_t dx, dy;
+    uint8_t direction;
+  } cases[] = {
+      {200, 10, TouchGesture::RIGHT},
+      {-200, 10, TouchGesture::LEFT},
+      {-10, 150, TouchGesture::DOWN},
+      {10, -150, TouchGesture::UP},
+  };
+  for (const auto &c : cases) {
+    ScriptedEvent script[12];
+    script[0] = {TouchEvent::DOWN, 160, 120, 1000};
+    for (int ii = 1; ii <= 10; ii++) {   // 10 steps, 10 ms apart
+      script[ii] = {TouchEvent::MOVE, (int16_t)(160 + c.dx * ii / 10), (int16_t)(120 + c.dy * ii / 10), 1000 + 10u * ii};
+    }
+    script[11] = {TouchEvent::UP, (int16_t)(160 + c.dx), (int16_t)(120 + c.dy), 1100};
+
+    TouchGestureRecognizer gestures;
+    TouchGesture found[4];
+    CHECK_EQ(1, play(gestures, script, 12, 1500, found, 4));
+    CHECK_EQ(TouchGesture::SWIPE, found[0].type);
+    CHECK_EQ(c.direction, found[0].direction);
+    CHECK_EQ(c.dx * 10, found[0].vx);   // a tenth of the travel every 10 ms
+    CHECK_EQ(c.dy * 10, found[0].vy);
+    CHECK_EQ(160, found[0].point.x);   // where the swipe started
+  }
+}
+
+TEST(gesture_pending_tap_flushed_by_distant_tap) {
+  const ScriptedEvent script[] = {
+      {TouchEvent::DOWN, 20, 20, 1000},
+      {TouchEvent::UP, 20, 20, 1060},
+      {TouchEvent::DOWN, 300, 200, 1150},   // in time for a double-tap, but elsewhere
+      {TouchEvent::UP, 300, 200, 1210},
+  };
+  TouchGestureRecognizer gestures;
+  TouchGesture found[4];
+  CHECK_EQ(2, play(gestures, script, 4, 2000, found, 4));
+  CHECK_EQ(TouchGesture::TAP, found[0].type);   // the first tap, flushed by the second lift
+  CHECK_EQ(20, found[0].point.x);
+  CHECK_EQ(1210u, found[0].ms);
+  CHECK_EQ(TouchGesture::TAP, found[1].type);   // the second, once the double-tap window passed
+  CHECK_EQ(300, found[1].point.x);
+}
+
+TEST(gesture_swipe_end_to_end) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setScreenSize(240, 320);
+  TouchGestureRecognizer gestures;
+  TouchGesture gesture;
+  int swipes = 0;
+  int others = 0;
+
+  // drag across the panel in portrait, left to right, in 200 ms
+  for (int ms = 0; ms < 600; ms++) {
+    if (ms < 200) {
+      panel.touch(200 + ms * 3, 500);
+    } else {
+      panel.release();
+    }
+    for (int ii = 0; ii < 10; ii++) {
+      TouchEvent event;
+      if (tsn.nextTouchEvent(&event, 0) && gestures.feed(event, &gesture)) {
+        swipes += (gesture.type == TouchGesture::SWIPE && gesture.direction == TouchGesture::RIGHT);
+        others += (gesture.type != TouchGesture::SWIPE);
+      }
+      panel.advanceMicros(100);
+    }
+    if (gestures.poll(panel.millis(), &gesture)) {
+      others++;
+    }
+  }
+  CHECK_EQ(1, swipes);
+  CHECK_EQ(0, others);
+}
@@ -0,0 +1,60 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_hit_index.cpp
+
+  Purpose:  TouchHitIndex must find the same control as a linear scan, everywhere
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Touch_Hit_Index.h>
+
+TEST(hit_index_edge_of_screen) {
+  TouchHitIndex<10> index;
+  index.begin(256, 256);
+  index.add(7, 200, 200, 100, 100);   // runs off the right and bottom edges
+  index.add(8, -20, -20, 40, 40);     // and off the top left corner
+  index.build();
+  CHECK(index.indexed());
+
+  const TSPoint points[] = {{256, 256, 0}, {255, 255, 0}, {299, 210, 0}, {300, 210, 0}, {-5, -5, 0}, {-21, 0, 0}, {0, 0, 0}};
+  for (const TSPoint &p : points) {
+    CHECK_EQ(index.findLinear(p), index.find(p));
+  }
+  CHECK_EQ(7, index.find(TSPoint(256, 256, 0)));   // x == width is a normal result of mapTouchToScreen()
+  CHECK_EQ(8, index.find(TSPoint(-5, -5, 0)));
+}
+
+TEST(hit_index_matches_linear_scan) {
+  uint32_t seed = 0x12345678;
+  for (int layout = 0; layout < 20; layout++) {
+    TouchHitIndex<50> index;
+    index.begin(320, 240);
+    for (int16_t id = 0; id < 50; id++) {
+      seed = seed * 1664525UL + 1013904223UL;
+      int16_t x = (int16_t)((seed >> 8) % 340) - 10;
+      int16_t y = (int16_t)((seed >> 18) % 260) - 10;
+      index.add(id, x, y, 8 + (seed >> 4) % 60, 8 + (seed >> 12) % 40);
+    }
+    index.build();
+    for (int16_t y = -4; y <= 244; y += 3) {
+      for (int16_t x = -4; x <= 324; x += 3) {
+        TSPoint p(x, y, 0);
+        CHECK_EQ(index.findLinear(p), index.find(p));
+      }
+    }
+  }
+}
+
+TEST(hit_index_falls_back_when_full) {
+  TouchHitIndex<4> index;   // room for 16 cell entries
+  index.begin(320, 240);
+  for (int16_t id = 0; id < 4; id++) {
+    index.add(id, 0, 0, 320, 240);   // every control covers all 64 cells
+  }
+  index.build();
+  CHECK(!index.indexed());
+  CHECK_EQ(3, index.find(TSPoint(100, 100, 0)));   // the last added wins
+  CHECK(!index.add(4, 0, 0, 10, 10));              // and the index is full
+}
@@ -0,0 +1,82 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_lookup_tables.cpp
+
+  Purpose:  setLookupTables() maps within 1 pixel of the multiply, and the tables are
+            refilled by the setters rather than by the next touch, up to 1024 entries
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <stdlib.h>
+#include <string.h>
+
+// exposes the mapping, which is otherwise only reached through a touch
+class MappingScreen : public Resistive_Touch_Screen {
+public:
+  MappingScreen(TouchHal *hal)
+      : Resistive_Touch_Screen(hal, 300) {}
+  ScreenPoint map(int16_t x, int16_t y, int orientation) {
+    ScreenPoint screen;
+    mapTouchToScreen(PressPoint(x, y, 500), &screen, orientation);
+    return screen;
+  }
+};
+
+static const uint16_t ENTRIES = 1024;   // the largest table setLookupTables() takes
+static int16_t xTable[ENTRIES + 1], yTable[ENTRIES + 1];
+
+TEST(lookup_tables_match_multiply) {
+  SimulatedTouchPanel panel;
+  MappingScreen tables(&panel), multiply(&panel);
+  for (uint16_t entries = 16; entries <= ENTRIES; entries *= 4) {
+    CHECK(tables.setLookupTables(xTable, yTable, entries));
+    for (int orientation = 0; orientation < 4; orientation++) {
+      for (int16_t y = 0; y < 1024; y += 7) {
+        for (int16_t x = 0; x < 1024; x += 13) {
+          ScreenPoint a = tables.map(x, y, orientation);
+          ScreenPoint b = multiply.map(x, y, orientation);
+          CHECK(abs(a.x - b.x) <= 1 && abs(a.y - b.y) <= 1);
+        }
+      }
+    }
+  }
+}
+
+TEST(lookup_tables_filled_by_setters) {
+  SimulatedTouchPanel panel;
+  static int16_t before[ENTRIES + 1];
+  for (uint16_t entries = 256; entries <= ENTRIES; entries *= 4) {
+    MappingScreen tsn(&panel);
+    size_t bytes = (entries + 1) * sizeof(int16_t);
+
+    // nothing to fill before the first touch, which fills them for its orientation
+    memset(xTable, 0, sizeof(xTable));
+    CHECK(tsn.setLookupTables(xTable, yTable, entries));
+    CHECK_EQ(0, xTable[entries]);
+    tsn.map(500, 500, 1);
+    CHECK(xTable[entries] != 0);
+
+    // each setter refills the tables at once; the next touch leaves them alone
+    for (int step = 0; step < 3; step++) {
+      if (step == 2) {
+        memset(xTable, 0, bytes);
+      }
+      memcpy(before, xTable, bytes);
+      if (step == 0) {
+        tsn.setScreenSize(480, 320);
+      } else if (step == 1) {
+        tsn.setResistanceRange(100, 900, 120, 880, 300);
+      } else {
+        CHECK(tsn.setLookupTables(xTable, yTable, entries));
+      }
+      CHECK(memcmp(before, xTable, bytes) != 0);
+      memcpy(before, xTable, bytes);
+      tsn.map(500, 500, 1);
+      CHECK(memcmp(before, xTable, bytes) == 0);
+    }
+  }
+}
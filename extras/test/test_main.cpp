@@ -0,0 +1,41 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_main.cpp
+
+  Purpose:  Run every registered TEST(), see test.h
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+
+static TestCase *tests    = nullptr;
+static TestCase *lastTest = nullptr;
+static int failures       = 0;
+
+TestCase::TestCase(const char *name, TestFunction function)
+    : name(name), function(function), next(nullptr) {
+  // keep the order of definition, so output is stable
+  if (lastTest) {
+    lastTest->next = this;
+  } else {
+    tests = this;
+  }
+  lastTest = this;
+}
+
+void testFailed(const char *file, int line, const char *condition) {
+  printf("  FAIL %s:%d: %s\n", file, line, condition);
+  failures++;
+}
+
+int main(void) {
+  int count = 0;
+  for (TestCase *test = tests; test; test = test->next) {
+    printf("%s\n", test->name);
+    test->function();
+    count++;
+  }
+  printf("%d tests, %d failed checks\n", count, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_oversampling.cpp
+
+  Purpose:  Oversampling and the reducers of Touch_Filters.h, on the simulated panel
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+// poll() until a sample completes, or give up after max_calls
+static bool pollSample(Resistive_Touch_Screen &tsn, int max_calls) {
+  for (int ii = 0; ii < max_calls; ii++) {
+    if (tsn.poll()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST(oversampling_reduced_during_poll_cycle) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  panel.touch(500, 600);
+
+  // stop partway through the X samples, then ask for fewer samples than already taken
+  tsn.setOversampling(5, 3);
+  for (int ii = 0; ii < 3; ii++) {
+    tsn.poll();
+  }
+  tsn.setOversampling(1, 1);
+
+  // Z1, Z2, X, Y
+  CHECK(pollSample(tsn, 4));
+  CHECK_EQ(500, tsn.lastSample().x);
+  CHECK_EQ(600, tsn.lastSample().y);
+}
+
+TEST(reducers_match_sorted_samples) {
+  uint16_t v[TouchFilter::MAX_SAMPLES];
+  const uint16_t samples[] = {40, 900, 10, 30, 20, 1023, 50, 0, 60};
+  for (uint8_t n = 3; n <= TouchFilter::MAX_SAMPLES; n += 2) {
+    // brute force: sort a copy with an insertion sort
+    uint16_t sorted[TouchFilter::MAX_SAMPLES];
+    for (uint8_t ii = 0; ii < n; ii++) {
+      uint16_t value = samples[ii];
+      uint8_t jj     = ii;
+      for (; jj > 0 && sorted[jj - 1] > value; jj--) {
+        sorted[jj] = sorted[jj - 1];
+      }
+      sorted[jj] = value;
+    }
+
+    memcpy(v, samples, sizeof(v));
+    CHECK_EQ(sorted[n / 2], TouchFilter::reduce(v, n, TouchFilter::MEDIAN));
+
+    uint8_t trim = n / 4;
+    uint32_t sum = 0;
+    for (uint8_t ii = trim; ii < n - trim; ii++) {
+      sum += sorted[ii];
+    }
+    memcpy(v, samples, sizeof(v));
+    CHECK_EQ((sum + (n - 2 * trim) / 2) / (n - 2 * trim), TouchFilter::reduce(v, n, TouchFilter::TRIMMED_MEAN));
+
+    sum = 0;
+    for (uint8_t ii = 1; ii < n - 1; ii++) {
+      sum += sorted[ii];
+    }
+    memcpy(v, samples, sizeof(v));
+    CHECK_EQ((sum + (n - 2) / 2) / (n - 2), TouchFilter::reduce(v, n, TouchFilter::MINMAX_MEAN));
+  }
+}
+
+// spread of repeated getPoint() X readings on a noisy panel, as the sum of squared errors
+static uint32_t squaredError(uint8_t samples, uint8_t reducer) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  panel.setNoise(8);
+  panel.touch(500, 500);
+  tsn.setOversampling(samples, 3, reducer);
+  uint32_t sum = 0;
+  for (int ii = 0; ii < 500; ii++) {
+    int error = tsn.getPoint().x - 500;
+    sum += error * error;
+  }
+  return sum;
+}
+
+TEST(oversampling_reduces_noise) {
+  uint32_t single = squaredError(1, TouchFilter::MEDIAN);
+  for (uint8_t reducer = TouchFilter::MEDIAN; reducer <= TouchFilter::MINMAX_MEAN; reducer++) {
+    uint32_t five = squaredError(5, reducer);
+    uint32_t nine = squaredError(9, reducer);
+    printf("  reducer %d: squared error x1 %lu, x5 %lu, x9 %lu\n", reducer,
+           (unsigned long)single, (unsigned long)five, (unsigned long)nine);
+    CHECK(five < single / 2);
+    CHECK(nine < five);
+  }
+}
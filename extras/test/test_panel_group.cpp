@@ -0,0 +1,91 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_panel_group.cpp
+
+  Purpose:  Two screens with independent touch state, serviced by one TouchPanelGroup
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+struct TapCount {
+  int taps[2] = {0, 0};
+  ScreenPoint last[2];
+};
+
+// service the group a number of times, counting taps per panel
+static void service(TouchPanelGroup &group, SimulatedTouchPanel panels[2], int calls, TapCount *count) {
+  for (int ii = 0; ii < calls; ii++) {
+    panels[0].resetCounters();
+    panels[1].resetCounters();
+    ScreenPoint screen;
+    int8_t index = group.pollScreenTap(&screen);
+    CHECK(panels[0].readCalls + panels[1].readCalls <= 1);   // one panel, one phase per call
+    CHECK(index >= -1 && index <= 1);
+    if (index >= 0) {
+      count->taps[index]++;
+      count->last[index] = screen;
+    }
+    panels[0].advanceMicros(100);
+    panels[1].advanceMicros(100);
+  }
+}
+
+TEST(panel_group_taps_tagged_by_panel) {
+  SimulatedTouchPanel panels[2];
+  Resistive_Touch_Screen left(&panels[0], 0);
+  Resistive_Touch_Screen right(&panels[1], 0);
+  left.setScreenSize(320, 240);
+  right.setScreenSize(240, 320);
+  TouchPanelGroup group;
+  CHECK(group.add(&left, 1));    // landscape
+  CHECK(group.add(&right, 0));   // portrait
+  CHECK_EQ(2, group.count());
+
+  TapCount count;
+  service(group, panels, 100, &count);
+  CHECK_EQ(0, count.taps[0] + count.taps[1]);
+
+  // touching the left panel reports one tap, from the left panel, however long it is held
+  panels[0].touch(100, 100);
+  service(group, panels, 200, &count);
+  CHECK_EQ(1, count.taps[0]);
+  CHECK_EQ(0, count.taps[1]);
+  CHECK(count.last[0].x < 160 && count.last[0].y > 120);   // lower left in landscape
+
+  // the right panel's touch is its own, while the left is still held
+  panels[1].touch(100, 100);
+  service(group, panels, 200, &count);
+  CHECK_EQ(1, count.taps[0]);
+  CHECK_EQ(1, count.taps[1]);
+  CHECK(count.last[1].x < 120 && count.last[1].y < 160);   // upper left in portrait
+
+  // releasing one panel does not release the other
+  panels[0].release();
+  service(group, panels, 200, &count);
+  panels[0].touch(900, 900);
+  service(group, panels, 200, &count);
+  CHECK_EQ(2, count.taps[0]);
+  CHECK_EQ(1, count.taps[1]);
+
+  panels[0].release();
+  panels[1].release();
+  service(group, panels, 200, &count);
+  CHECK_EQ(2, count.taps[0]);
+  CHECK_EQ(1, count.taps[1]);
+}
+
+TEST(panel_group_capacity) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  TouchPanelGroup group;
+  ScreenPoint screen;
+  CHECK_EQ(-1, group.pollScreenTap(&screen));   // empty group
+  for (int ii = 0; ii < TouchPanelGroup::MAX_PANELS; ii++) {
+    CHECK(group.add(&tsn, 1));
+  }
+  CHECK(!group.add(&tsn, 1));
+}
@@ -0,0 +1,63 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_poll.cpp
+
+  Purpose:  poll() does at most one ADC conversion per call, whatever the panel is doing
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+// poll() a number of times, checking the HAL calls made by each call
+static int pollBounded(Resistive_Touch_Screen &tsn, SimulatedTouchPanel &panel, int calls) {
+  int samples = 0;
+  for (int ii = 0; ii < calls; ii++) {
+    panel.resetCounters();
+    samples += tsn.poll();
+    CHECK(panel.readCalls <= 1);
+    CHECK(panel.pinModeCalls <= TouchHal::NUM_PLATES);   // one plate configuration at most
+    CHECK(panel.writeCalls <= TouchHal::NUM_PLATES);
+    panel.advanceMicros(100);
+  }
+  return samples;
+}
+
+TEST(poll_one_conversion_per_call) {
+  for (uint16_t rx = 0; rx <= 300; rx += 300) {   // pressure in counts, then in ohms
+    SimulatedTouchPanel panel;
+    Resistive_Touch_Screen tsn(&panel, rx);
+    panel.setNoise(3);
+
+    // idle
+    CHECK_EQ(0, pollBounded(tsn, panel, 50));
+
+    // touched, one sample per coordinate: Z1, Z2, X, Y
+    panel.touch(300, 700);
+    CHECK(pollBounded(tsn, panel, 40) >= 9);
+    CHECK(tsn.pollTouched());
+
+    // touched and oversampled: each of the 9 X and 9 Y samples takes its own call
+    tsn.setOversampling(9, 3, TouchFilter::MEDIAN);
+    int samples = pollBounded(tsn, panel, 200);
+    CHECK(samples >= 9 && samples <= 10);   // 200 calls / (2 + 9 + 9) per sample
+
+    // released
+    panel.release();
+    pollBounded(tsn, panel, 50);
+    CHECK(!tsn.pollTouched());
+
+    // adaptive polling: idle pen-down checks, then the wake-up on touch
+    tsn.setOversampling(1, 1);
+    tsn.setPollRate(64, 10);
+    pollBounded(tsn, panel, 200);
+    panel.touch(500, 500);
+    for (int ii = 0; ii < 100; ii++) {
+      pollBounded(tsn, panel, 1);
+      panel.advanceMicros(1000);
+    }
+    CHECK(tsn.pollTouched());
+  }
+}
@@ -0,0 +1,87 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_poll_rate.cpp
+
+  Purpose:  Adaptive polling: idle backoff, pen-down wake-up and the duty cycle statistic
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+// call poll() every 100 us of simulated time for the given number of milliseconds
+static void run(Resistive_Touch_Screen &tsn, SimulatedTouchPanel &panel, uint32_t ms) {
+  for (uint32_t ii = 0; ii < ms * 10; ii++) {
+    tsn.poll();
+    panel.advanceMicros(100);
+  }
+}
+
+TEST(poll_rate_backoff_and_wakeup) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  panel.setConversionMicros(20);
+  tsn.setPollRate(80, 10);
+  CHECK_EQ(80, tsn.pollIntervalMs());   // starts idle
+
+  // touched: full cycles at the active rate
+  panel.touch(500, 500);
+  run(tsn, panel, 100);
+  CHECK(tsn.pollTouched());
+  CHECK_EQ(10, tsn.pollIntervalMs());
+
+  // released: the interval doubles after every idle pen-down check, up to idle_ms
+  panel.release();
+  uint16_t seen[8];
+  int changes       = 0;
+  uint16_t interval = tsn.pollIntervalMs();
+  for (int ms = 0; ms < 500 && changes < 8; ms++) {
+    run(tsn, panel, 1);
+    if (tsn.pollIntervalMs() != interval) {
+      interval        = tsn.pollIntervalMs();
+      seen[changes++] = interval;
+    }
+  }
+  CHECK(!tsn.pollTouched());
+  CHECK_EQ(3, changes);
+  CHECK_EQ(20, seen[0]);
+  CHECK_EQ(40, seen[1]);
+  CHECK_EQ(80, seen[2]);   // doubling would be 80 either way; capped from here on
+  run(tsn, panel, 500);
+  CHECK_EQ(80, tsn.pollIntervalMs());
+
+  // idle cycles are one pen-down conversion each
+  panel.resetCounters();
+  run(tsn, panel, 800);
+  CHECK(panel.readCalls >= 9 && panel.readCalls <= 11);   // 800 ms / 80 ms
+
+  // a touch is noticed by the next pen-down check, and the rate goes back up
+  panel.touch(500, 500);
+  run(tsn, panel, 81);
+  CHECK(tsn.pollTouched());
+  CHECK_EQ(10, tsn.pollIntervalMs());
+}
+
+TEST(poll_rate_duty_cycle) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  panel.setConversionMicros(20);
+  tsn.setPollRate(80, 10);
+
+  // idle for over a second: one 20 us conversion every 80 ms is well under 1 permille
+  run(tsn, panel, 2100);
+  CHECK_EQ(0, tsn.dutyCyclePermille());
+
+  // touched: four 20 us conversions every 10 ms is 8 permille
+  panel.touch(500, 500);
+  run(tsn, panel, 2100);
+  printf("  duty cycle while touched: %d permille\n", tsn.dutyCyclePermille());
+  CHECK(tsn.dutyCyclePermille() >= 7 && tsn.dutyCyclePermille() <= 9);
+
+  // and back down once released
+  panel.release();
+  run(tsn, panel, 3100);
+  CHECK_EQ(0, tsn.dutyCyclePermille());
+}
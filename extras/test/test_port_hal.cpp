@@ -0,0 +1,130 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_port_hal.cpp
+
+  Purpose:  PortTouchHal on the host's mock PORT registers (extras/host/Mock_Port.h):
+            drivePhase() leaves every plate as the per-plate calls would, writing only
+            what changes from the last phase, and the library takes whole phases
+            through it.
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+// PortTouchHal with the simulated panel behind the pins: each phase is also applied to
+// the panel, which supplies the conversions and the clock
+class SimulatedPortHal : public PortTouchHal {
+public:
+  SimulatedPortHal(SimulatedTouchPanel *panel)
+      : PortTouchHal(A3, A5, A4, 9)
+      , _panel(panel) {}
+
+  bool drivePhase(uint8_t phase, uint8_t from) override {
+    for (uint8_t plate = 0; plate < NUM_PLATES; plate++) {
+      _panel->setPinMode(plate, (phaseOutputs(phase) & (1 << plate)) ? OUTPUT : INPUT);
+      _panel->writePin(plate, (phaseHighs(phase) & (1 << plate)) ? HIGH : LOW);
+    }
+    return PortTouchHal::drivePhase(phase, from);
+  }
+  int readPin(uint8_t plate) override { return _panel->readPin(plate); }
+  uint32_t millis(void) override { return _panel->millis(); }
+  uint32_t micros(void) override { return _panel->micros(); }
+  void delayMicroseconds(uint16_t us) override { _panel->delayMicroseconds(us); }
+
+private:
+  SimulatedTouchPanel *_panel;
+};
+
+static const uint8_t pins[TouchHal::NUM_PLATES] = {A3, A5, A4, 9};   // XP, YP, XM, YM
+
+// one bit per plate, read from the mock DIR or OUT of its port group
+static uint8_t plateBits(uint32_t PortGroup::*reg) {
+  uint8_t bits = 0;
+  for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+    const PinDescription &d = g_APinDescription[pins[plate]];
+    if ((PORT->Group[d.ulPort].*reg >> d.ulPin) & 1) {
+      bits |= (1 << plate);
+    }
+  }
+  return bits;
+}
+
+static uint32_t &pinConfig(uint8_t plate) {
+  const PinDescription &d = g_APinDescription[pins[plate]];
+  return PORT->Group[d.ulPort].pincfg[d.ulPin];
+}
+
+TEST(port_hal_drive_phase) {
+  PortTouchHal hal(pins[TouchHal::XP], pins[TouchHal::YP], pins[TouchHal::XM], pins[TouchHal::YM]);
+  const uint8_t UNKNOWN = TouchHal::NUM_PHASES;
+  for (uint8_t phase = 0; phase < TouchHal::NUM_PHASES; phase++) {
+    uint32_t writes[UNKNOWN + 1];
+    for (uint8_t from = 0; from <= UNKNOWN; from++) {
+      hal.drivePhase(from < UNKNOWN ? from : (phase + 1) % TouchHal::NUM_PHASES, UNKNOWN);
+      for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+        pinConfig(plate) = PORT_PINCFG_PMUXEN;   // as analogRead() leaves it
+      }
+      Port::writes = 0;
+      CHECK(hal.drivePhase(phase, from));
+      writes[from] = Port::writes;
+      CHECK_EQ(TouchHal::phaseOutputs(phase), plateBits(&PortGroup::dir));
+      CHECK_EQ(TouchHal::phaseHighs(phase), plateBits(&PortGroup::out));
+      for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+        bool stays = from < UNKNOWN && (TouchHal::phaseOutputs(from) & (1 << plate));
+        if ((TouchHal::phaseOutputs(phase) & (1 << plate)) && !stays) {
+          CHECK_EQ(PORT_PINCFG_INEN | PORT_PINCFG_DRVSTR, pinConfig(plate));   // digital again
+        }
+      }
+    }
+    CHECK_EQ(0u, writes[phase]);
+    printf("  phase %d: %u register writes", phase, (unsigned)writes[UNKNOWN]);
+    for (uint8_t from = 0; from < UNKNOWN; from++) {
+      if (from != phase) {
+        CHECK(writes[from] < writes[UNKNOWN]);
+        printf(", %u from phase %d", (unsigned)writes[from], from);
+      }
+    }
+
+    // the same pin states one plate at a time, from an unknown state
+    Port::writes = 0;
+    for (uint8_t plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+      hal.setPinMode(plate, (TouchHal::phaseOutputs(phase) & (1 << plate)) ? OUTPUT : INPUT);
+      hal.writePin(plate, (TouchHal::phaseHighs(phase) & (1 << plate)) ? HIGH : LOW);
+    }
+    CHECK_EQ(TouchHal::phaseOutputs(phase), plateBits(&PortGroup::dir));
+    CHECK_EQ(TouchHal::phaseHighs(phase), plateBits(&PortGroup::out));
+    printf(", %u one plate at a time\n", (unsigned)Port::writes);
+    CHECK(writes[UNKNOWN] < Port::writes);
+  }
+}
+
+TEST(port_hal_through_library) {
+  SimulatedTouchPanel panel, reference;
+  SimulatedPortHal hal(&panel);
+  Resistive_Touch_Screen tsn(&hal, 0), plain(&reference, 0);
+  panel.touch(300, 700);
+  reference.touch(300, 700);
+
+  // the same measurements as the per-plate path, with no pin work when the phase is unchanged
+  for (int ii = 0; ii < 3; ii++) {
+    TSPoint p = tsn.getPoint();
+    TSPoint q = plain.getPoint();
+    CHECK_EQ(q.x, p.x);
+    CHECK_EQ(q.y, p.y);
+    CHECK_EQ(q.z, p.z);
+  }
+  CHECK_EQ(plain.pinTransitionsExecuted(), tsn.pinTransitionsExecuted());
+  CHECK_EQ(plain.pinTransitionsSkipped(), tsn.pinTransitionsSkipped());
+
+  Port::writes = 0;
+  tsn.getPoint();
+  uint32_t writes = Port::writes;
+  CHECK(writes > 0);
+  tsn.resetPinCache();
+  Port::writes = 0;
+  tsn.getPoint();
+  CHECK(writes < Port::writes);   // from an unknown phase every plate is written
+}
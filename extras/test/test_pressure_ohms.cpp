@@ -0,0 +1,44 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_pressure_ohms.cpp
+
+  Purpose:  With rx given, getPoint() reports the contact resistance of the simulated
+            panel in ohms
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <stdlib.h>
+
+// contact resistance read back at one place on the panel
+static int16_t readOhms(Resistive_Touch_Screen &tsn, SimulatedTouchPanel &panel, int16_t x, int16_t y, uint16_t contact) {
+  panel.touch(x, y, contact);
+  return tsn.getPoint().z;
+}
+
+TEST(pressure_in_ohms_matches_contact) {
+  SimulatedTouchPanel panel(310, 590);
+  Resistive_Touch_Screen tsn(&panel, 310);
+
+  // in the middle of the panel, within 2% from a firm to a very light touch
+  for (uint16_t contact = 200; contact <= 3000; contact += 100) {
+    CHECK(abs(readOhms(tsn, panel, 500, 400, contact) - contact) * 50 <= contact);
+  }
+
+  // toward X+ the Z1 reading is small, so one count of ADC rounding weighs more;
+  // the result is further off but still orders touches by firmness
+  for (int16_t x = 100; x <= 900; x += 200) {
+    for (int16_t y = 100; y <= 900; y += 200) {
+      int16_t previous = 0;
+      for (uint16_t contact = 200; contact <= 3000; contact += 400) {
+        int16_t ohms = readOhms(tsn, panel, x, y, contact);
+        CHECK(abs(ohms - contact) * 100 <= contact * 12);
+        CHECK(ohms > previous);
+        previous = ohms;
+      }
+    }
+  }
+}
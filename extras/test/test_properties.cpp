@@ -0,0 +1,126 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_properties.cpp
+
+  Purpose:  Properties that must hold for every input: mapTouchToScreen() on random
+            touches, and newScreenTap() on a random stream of measurements.
+            extras/test/fuzz runs the tap property under libFuzzer.
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "fixed_readings_hal.h"
+#include "test.h"
+#include <Touch_Simulator.h>
+#include <stdlib.h>
+
+// repeatable pseudo-random numbers (xorshift32)
+static uint32_t testRandom(uint32_t *seed) {
+  uint32_t x = *seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *seed = x;
+  return x;
+}
+
+// true if delta does not reverse the direction seen so far along a sweep
+static bool keepsDirection(int8_t *direction, int delta) {
+  if (delta == 0) {
+    return true;
+  }
+  int8_t sign = (delta > 0) ? 1 : -1;
+  if (*direction == 0) {
+    *direction = sign;
+  }
+  return *direction == sign;
+}
+
+// In every orientation: the result is on the screen, rotating the screen 180 degrees
+// mirrors the result, and sliding along one touch axis moves the result in one direction only
+static void checkMapping(ProbeScreen &tsn, int width, int height) {
+  uint32_t seed = 0x2545F491;
+  for (int o = 0; o < 4; o++) {
+    for (int ii = 0; ii < 200; ii++) {
+      PressPoint p(testRandom(&seed) % 1024, testRandom(&seed) % 1024, 500);
+      ScreenPoint s, flipped;
+      tsn.mapTouchToScreen(p, &s, o);
+      tsn.mapTouchToScreen(p, &flipped, (o + 2) % 4);
+      CHECK(s.x >= 0 && s.x <= width && s.y >= 0 && s.y <= height);
+      CHECK(abs(s.x + flipped.x - width) <= 1 && abs(s.y + flipped.y - height) <= 1);
+    }
+
+    for (int axis = 0; axis < 2; axis++) {
+      PressPoint p(testRandom(&seed) % 1024, testRandom(&seed) % 1024, 500);
+      int16_t *slide = (axis == 0) ? &p.x : &p.y;
+      *slide         = 0;
+      ScreenPoint prev;
+      tsn.mapTouchToScreen(p, &prev, o);
+      int8_t xDirection = 0;
+      int8_t yDirection = 0;
+      for (int t = 8; t < 1024; t += 8) {
+        *slide = t;
+        ScreenPoint s;
+        tsn.mapTouchToScreen(p, &s, o);
+        CHECK(keepsDirection(&xDirection, s.x - prev.x) && keepsDirection(&yDirection, s.y - prev.y));
+        prev = s;
+      }
+    }
+  }
+}
+
+// Never a tap without a touch, or two taps without a release between them
+static void checkTaps(ProbeScreen &tsn, FixedReadingsHal &hal) {
+  TapWatch watch;
+  uint32_t seed = 0x9E3779B9;
+  for (int step = 0; step < 4000; step++) {
+    if (testRandom(&seed) % 4 == 0) {
+      // new measurements, often at the extremes so that full presses and releases occur
+      for (int plate = 0; plate < TouchHal::NUM_PLATES; plate++) {
+        switch (testRandom(&seed) % 3) {
+        case 0:
+          hal.reading[plate] = 0;
+          break;
+        case 1:
+          hal.reading[plate] = 1023;
+          break;
+        default:
+          hal.reading[plate] = testRandom(&seed) % 1024;
+          break;
+        }
+      }
+    }
+    ScreenPoint screen;
+    CHECK(watch.check(tsn, tsn.newScreenTap(&screen, 1)));
+  }
+  printf("  %d taps and %d releases\n", watch.taps, watch.releases);
+  CHECK(watch.taps > 10 && watch.releases > 10);   // the stream exercised both edges
+}
+
+TEST(properties_mapping) {
+  SimulatedTouchPanel panel;
+  ProbeScreen counts(&panel, 0);
+  checkMapping(counts, 320, 240);
+  ProbeScreen ohms(&panel, 300);
+  checkMapping(ohms, 320, 240);
+  ProbeScreen narrow(&panel, 0);
+  narrow.setScreenSize(480, 320);
+  narrow.setResistanceRange(100, 900, 120, 880, 300);
+  checkMapping(narrow, 480, 320);
+}
+
+// must hold however the acquisition is configured
+TEST(properties_taps) {
+  FixedReadingsHal hal;
+  ProbeScreen counts(&hal, 0);
+  checkTaps(counts, hal);
+  ProbeScreen ohms(&hal, 300);
+  checkTaps(ohms, hal);
+  ProbeScreen unvalidated(&hal, 0);
+  unvalidated.setTapValidation(0, 0);
+  checkTaps(unvalidated, hal);
+  ProbeScreen oversampled(&hal, 0);
+  oversampled.setTapValidation(5, 1);
+  oversampled.setOversampling(5, 3, TouchFilter::TRIMMED_MEAN);
+  checkTaps(oversampled, hal);
+}
@@ -0,0 +1,112 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_sampler.cpp
+
+  Purpose:  Background sampling through sampleFromISR(), driven by a simulated timer,
+            and the ring buffer behind it
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+// Stands in for a hardware timer: every period, simulated time moves on and the
+// "interrupt handler" runs. The touch slides to the right by one count per tick,
+// so each finished sample can be told apart from the others.
+class SimulatedTimer {
+public:
+  SimulatedTimer(SimulatedTouchPanel &panel, Resistive_Touch_Screen &tsn, uint32_t period_us)
+      : _panel(panel), _tsn(tsn), _periodUs(period_us) {}
+
+  void run(int ticks) {
+    for (int ii = 0; ii < ticks; ii++) {
+      _panel.advanceMicros(_periodUs);
+      _panel.touch(100 + _tick, 500);
+      _tsn.sampleFromISR();
+      _tick++;
+    }
+  }
+
+protected:
+  SimulatedTouchPanel &_panel;
+  Resistive_Touch_Screen &_tsn;
+  uint32_t _periodUs;
+  int _tick = 0;
+};
+
+TEST(ring_buffer_order_and_boundaries) {
+  TouchRingBuffer<int, 4> ring = TouchRingBuffer<int, 4>();   // holds 3: one slot stays empty
+  int item = -1;
+  CHECK(!ring.pop(&item));
+  CHECK_EQ(-1, item);
+  for (int ii = 0; ii < 3; ii++) {
+    CHECK(ring.push(ii));
+  }
+  CHECK_EQ(3, ring.count());
+  CHECK(!ring.push(99));   // full
+  CHECK_EQ(1, ring.dropped());
+  for (int ii = 0; ii < 3; ii++) {
+    CHECK(ring.pop(&item));
+    CHECK_EQ(ii, item);
+  }
+  CHECK(!ring.pop(&item));   // empty again
+
+  // wrap around the end of the storage many times
+  for (int ii = 0; ii < 20; ii++) {
+    CHECK(ring.push(ii));
+    CHECK(ring.pop(&item));
+    CHECK_EQ(ii, item);
+  }
+  CHECK_EQ(0, ring.count());
+  CHECK_EQ(1, ring.dropped());
+}
+
+TEST(sampler_drained_in_time) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  SimulatedTimer timer(panel, tsn, 250);
+
+  // drain after every few ticks, like a loop() that keeps up
+  int samples  = 0;
+  int16_t last = -1;
+  for (int pass = 0; pass < 100; pass++) {
+    timer.run(8);   // two samples of Z1, Z2, X, Y
+    PressPoint p;
+    while (tsn.readSample(&p)) {
+      CHECK(p.x > last);   // in the order measured
+      CHECK_EQ(500, p.y);
+      last = p.x;
+      samples++;
+    }
+  }
+  CHECK_EQ(200, samples);
+  CHECK_EQ(0, tsn.droppedSamples());
+}
+
+TEST(sampler_overrun_counts_dropped) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  SimulatedTimer timer(panel, tsn, 250);
+
+  // loop() stalls for 12 samples; the 8-slot buffer keeps the first 7
+  timer.run(12 * 4);
+  CHECK_EQ(5, tsn.droppedSamples());
+  PressPoint p;
+  int16_t last = -1;
+  int samples  = 0;
+  while (tsn.readSample(&p)) {
+    CHECK(p.x > last);
+    last = p.x;
+    samples++;
+  }
+  CHECK_EQ(7, samples);
+  CHECK(last < 100 + 7 * 4);   // the oldest samples were kept, the newest dropped
+
+  // sampling carries on once there is room again
+  timer.run(4);
+  CHECK(tsn.readSample(&p));
+  CHECK(p.x > last);
+  CHECK_EQ(5, tsn.droppedSamples());
+}
@@ -0,0 +1,80 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_settling.cpp
+
+  Purpose:  autoTuneSettling() picks the shortest delay that brings an under-settled
+            simulated panel within the variance target, and says so when none does
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+static const uint16_t TARGET = 12;   // variance in counts squared
+static const uint16_t MAX_US = 200;  // sweep of 20 steps of 10 us
+
+// variance of X and Y over 64 single-sample readings of a held touch, at the current delays
+static void measureVariance(Resistive_Touch_Screen &tsn, uint32_t *x_var, uint32_t *y_var) {
+  const uint32_t N = 64;
+  uint32_t sx = 0, sxx = 0, sy = 0, syy = 0;
+  for (uint32_t ii = 0; ii < N; ii++) {
+    TSPoint p = tsn.getPoint();
+    sx += p.x;
+    sxx += (uint32_t)p.x * p.x;
+    sy += p.y;
+    syy += (uint32_t)p.y * p.y;
+  }
+  *x_var = (sxx * N - sx * sx) / (N * N);
+  *y_var = (syy * N - sy * sy) / (N * N);
+}
+
+TEST(settling_picks_shortest_delay) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(1);
+  panel.setSettling(115, 200);   // up to 200 counts of extra noise, gone after 115 us
+  panel.touch(500, 500);
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setOversampling(1, 1);
+
+  CHECK(tsn.autoTuneSettling(TARGET, MAX_US));
+  uint16_t x_us, y_us, z_us;
+  tsn.getSettleMicros(&x_us, &y_us, &z_us);
+  CHECK_EQ(120, x_us);   // the first step at or past 115 us
+  CHECK_EQ(120, y_us);
+  CHECK_EQ(120, z_us);
+
+  // readings meet the target at the chosen delay, and miss it one step earlier
+  uint32_t x_var, y_var;
+  measureVariance(tsn, &x_var, &y_var);
+  CHECK(x_var <= TARGET && y_var <= TARGET);
+  tsn.setSettleMicros(x_us - 10, y_us - 10, z_us - 10);
+  measureVariance(tsn, &x_var, &y_var);
+  CHECK(x_var > TARGET && y_var > TARGET);
+}
+
+TEST(settling_not_needed) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(1);
+  panel.touch(500, 500);
+  Resistive_Touch_Screen tsn(&panel, 0);
+  CHECK(tsn.autoTuneSettling(TARGET, MAX_US));
+  uint16_t x_us, y_us, z_us;
+  tsn.getSettleMicros(&x_us, &y_us, &z_us);
+  CHECK_EQ(0, x_us + y_us + z_us);
+}
+
+TEST(settling_fails_when_sweep_too_short) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(1);
+  panel.setSettling(400, 200);   // still noisy at the end of the sweep
+  panel.touch(500, 500);
+  Resistive_Touch_Screen tsn(&panel, 0);
+  CHECK(!tsn.autoTuneSettling(TARGET, MAX_US));
+  uint16_t x_us, y_us, z_us;
+  tsn.getSettleMicros(&x_us, &y_us, &z_us);
+  CHECK_EQ(MAX_US, x_us);   // the longest delay tried is left in place
+  CHECK_EQ(MAX_US, y_us);
+  CHECK_EQ(MAX_US, z_us);
+}
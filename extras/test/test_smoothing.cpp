@@ -0,0 +1,134 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_smoothing.cpp
+
+  Purpose:  Smoothing of the nextTouchEvent() stream, see TouchSmoother, and the
+            jitter and lag of each mode on a synthetic trace.
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <math.h>
+
+// repeatable pseudo-random numbers for the trace (xorshift32)
+static uint32_t testRandom(uint32_t *seed) {
+  uint32_t x = *seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *seed = x;
+  return x;
+}
+
+// A touch held still at 500 with +/-4 counts of noise, then a fast drag. Smoothing must
+// reduce jitter while held, never leave the range of its input, and catch up with the drag.
+TEST(smoothing_jitter_and_lag) {
+  const int HOLD      = 200;   // samples held still
+  const int NOISE     = 4;
+  const int DRAG      = 40;   // then samples dragged 10 counts per sample
+  const int SPEED     = 10;
+  const char *names[] = {"off", "IIR", "One-Euro"};
+
+  for (uint8_t mode = TouchSmoother::OFF; mode <= TouchSmoother::ONE_EURO; mode++) {
+    TouchSmoother smoother;
+    smoother.configure(mode);
+    uint32_t seed   = 0x6A09E667;   // same trace for every mode
+    uint32_t rawSq  = 0;            // sum of squared sample-to-sample changes while held
+    uint32_t outSq  = 0;
+    int16_t prevRaw = 500;
+    int16_t prevOut = 500;
+    int lag         = 0;   // position error at the end of the drag, in samples of travel
+
+    for (int ii = 0; ii < HOLD + DRAG; ii++) {
+      int16_t raw = 500;
+      if (ii < HOLD) {
+        raw += (int16_t)(testRandom(&seed) % (2 * NOISE + 1)) - NOISE;
+      } else {
+        raw += (ii - HOLD + 1) * SPEED;
+      }
+      int16_t x = raw, y = raw;
+      smoother.apply(&x, &y);
+
+      if (ii > 0 && ii < HOLD) {
+        rawSq += (raw - prevRaw) * (raw - prevRaw);
+        outSq += (x - prevOut) * (x - prevOut);
+        CHECK(x >= 500 - NOISE && x <= 500 + NOISE);
+      }
+      if (ii >= HOLD) {
+        CHECK(x <= raw && x >= prevOut);   // no overshoot, no reversal
+      }
+      lag     = (raw - x + SPEED / 2) / SPEED;
+      prevRaw = raw;
+      prevOut = x;
+    }
+
+    // jitter is the RMS change between consecutive samples, as a percentage of the raw jitter
+    int jitterPercent = rawSq ? (int)(100 * sqrtf((float)outSq / rawSq) + 0.5f) : 0;
+    printf("  %-8s jitter %3d%% of raw, lag %d samples during the drag\n", names[mode], jitterPercent, lag);
+    if (mode != TouchSmoother::OFF) {
+      CHECK(jitterPercent < 50);
+    }
+    CHECK(lag <= 8);
+  }
+}
+
+// MOVE events from a touch held still for 20 seconds, polled every millisecond
+static int movesWhileHeld(uint8_t mode) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setScreenSize(320, 240);
+  tsn.setSmoothing(mode);
+  panel.setNoise(6);
+  panel.touch(512, 512);
+
+  int moves = 0;
+  TouchEvent event;
+  for (int ii = 0; ii < 20000; ii++) {
+    if (tsn.nextTouchEvent(&event, 1) && event.type == TouchEvent::MOVE) {
+      moves++;
+    }
+    panel.advanceMicros(1000);
+  }
+  return moves;
+}
+
+TEST(smoothing_suppresses_moves_while_held) {
+  int off     = movesWhileHeld(TouchSmoother::OFF);
+  int iir     = movesWhileHeld(TouchSmoother::IIR);
+  int oneEuro = movesWhileHeld(TouchSmoother::ONE_EURO);
+  printf("  MOVE events while held: off %d, IIR %d, One-Euro %d\n", off, iir, oneEuro);
+  CHECK(iir < off / 10);
+  CHECK(oneEuro < off / 10);
+}
+
+// the first sample of a new touch is reported where it is, not pulled toward the last touch
+TEST(smoothing_restarts_on_each_touch) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setScreenSize(320, 240);
+  tsn.setSmoothing(TouchSmoother::IIR);
+
+  TouchEvent first, second, event;
+  panel.touch(100, 100);
+  while (!tsn.nextTouchEvent(&first, 1)) {
+  }
+  panel.release();
+  while (!tsn.nextTouchEvent(&event, 1) || event.type != TouchEvent::UP) {
+  }
+  panel.touch(900, 900);
+  while (!tsn.nextTouchEvent(&second, 1)) {
+  }
+  CHECK_EQ(TouchEvent::DOWN, second.type);
+
+  SimulatedTouchPanel reference;
+  Resistive_Touch_Screen unsmoothed(&reference, 0);
+  unsmoothed.setScreenSize(320, 240);
+  reference.touch(900, 900);
+  while (!unsmoothed.nextTouchEvent(&event, 1)) {
+  }
+  CHECK_EQ(event.point.x, second.point.x);
+  CHECK_EQ(event.point.y, second.point.y);
+}
@@ -0,0 +1,46 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_tap_validation.cpp
+
+  Purpose:  newScreenTap() reports every tap of a steady touch, and its pressure-bracketed
+            X/Y check rejects single-call taps whose readings disagree
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <stdio.h>
+
+// press and release at 200 places, one newScreenTap() call each; returns the taps reported
+static int tapCycles(Resistive_Touch_Screen &tsn, SimulatedTouchPanel &panel) {
+  int taps = 0;
+  for (int ii = 0; ii < 200; ii++) {
+    ScreenPoint screen;
+    panel.touch(100 + (ii * 37) % 800, 100 + (ii * 53) % 800);
+    taps += tsn.newScreenTap(&screen, 0);
+    panel.release();
+    CHECK(!tsn.newScreenTap(&screen, 0));
+  }
+  return taps;
+}
+
+TEST(tap_validation_keeps_steady_taps) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(4);
+  Resistive_Touch_Screen tsn(&panel, 0);
+  CHECK_EQ(200, tapCycles(tsn, panel));
+}
+
+TEST(tap_validation_rejects_noisy_taps) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(40);
+  Resistive_Touch_Screen tsn(&panel, 0);
+  int validated = tapCycles(tsn, panel);
+  tsn.setTapValidation(0, 0);   // the old single read
+  int unvalidated = tapCycles(tsn, panel);
+  printf("  taps at 40 counts of noise: %d of 200 validated, %d of 200 without validation\n",
+         validated, unvalidated);
+  CHECK(validated + 50 < unvalidated);   // the single read lets through taps that validation rejects
+}
@@ -0,0 +1,132 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_trace.cpp
+
+  Purpose:  A session recorded through TouchTraceRecorder replays through TouchTraceReplay
+            into exactly the same taps and touch events
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+#include <Touch_Trace.h>
+
+static const int MAX_FOUND = 64;
+
+struct Found {
+  uint8_t type;
+  int16_t x, y, z;
+  uint32_t ms;
+};
+
+static bool same(const Found &a, const Found &b) {
+  return a.type == b.type && a.x == b.x && a.y == b.y && a.z == b.z && a.ms == b.ms;
+}
+
+// Collect one tap from pollScreenTap(), or one event from nextTouchEvent(), per call
+static void collect(Resistive_Touch_Screen &tsn, bool events, Found *found, int *n) {
+  ScreenPoint screen;
+  TouchEvent event;
+  uint8_t type = TouchEvent::NONE;
+  if (events) {
+    if (!tsn.nextTouchEvent(&event, 0)) {
+      return;
+    }
+    type   = event.type;
+    screen = event.point;
+  } else if (!tsn.pollScreenTap(&screen, 0)) {
+    return;
+  }
+  if (*n < MAX_FOUND) {
+    found[(*n)++] = {type, screen.x, screen.y, screen.z, event.ms};
+  }
+}
+
+// Touch the simulated panel at a few places, or drag across it, recording the conversions
+static int record(bool events, uint32_t seed, TouchTraceBuffer &trace, Found *found) {
+  SimulatedTouchPanel panel;
+  panel.setNoise(4);
+  panel.setSeed(seed);
+  panel.setSettling(20, 30);
+  TouchTraceRecorder recorder(&panel, trace);
+  recorder.begin();
+  Resistive_Touch_Screen tsn(&recorder, 300);
+  tsn.setSettleMicros(25, 25, 25);
+
+  int n = 0;
+  for (uint32_t ms = 0; ms < 600; ms++) {
+    uint16_t phase = ms % 150;
+    if (phase < 80) {
+      int16_t x = events ? 200 + phase * 8 : 150 + (ms / 150) * 170 + (seed % 7) * 10;
+      panel.touch(x, 400 + (seed % 5) * 60);
+    } else {
+      panel.release();
+    }
+    for (int ii = 0; ii < 10; ii++) {
+      collect(tsn, events, found, &n);
+      panel.advanceMicros(100);
+    }
+  }
+  CHECK(!trace.overflow);
+  CHECK(recorder.recorded > 0);
+  return n;
+}
+
+// Run an identically configured screen on the recorded conversions until they run out
+static int replay(bool events, const TouchTraceBuffer &trace, Found *found) {
+  TouchTraceReplay replay(trace.data(), trace.size());
+  Resistive_Touch_Screen tsn(&replay, 300);
+  tsn.setSettleMicros(25, 25, 25);
+
+  int n = 0;
+  while (!replay.finished()) {
+    collect(tsn, events, found, &n);
+  }
+  CHECK(!replay.diverged());
+  return n;
+}
+
+static void recordThenReplay(bool events) {
+  static uint8_t buffer[64 * 1024];
+  for (uint32_t seed = 1; seed <= 20; seed++) {
+    TouchTraceBuffer trace(buffer, sizeof(buffer));
+    Found recorded[MAX_FOUND], replayed[MAX_FOUND];
+    int n = record(events, seed, trace, recorded);
+    CHECK(n >= 4);   // 4 taps, or 4 drags of several events each
+    CHECK_EQ(n, replay(events, trace, replayed));
+    for (int ii = 0; ii < n; ii++) {
+      CHECK(same(recorded[ii], replayed[ii]));
+    }
+  }
+}
+
+TEST(trace_replays_identical_taps) {
+  recordThenReplay(false);
+}
+
+TEST(trace_replays_identical_events) {
+  recordThenReplay(true);
+}
+
+TEST(trace_replay_clock) {
+  static uint8_t buffer[16 * 1024];
+  TouchTraceBuffer trace(buffer, sizeof(buffer));
+  Found found[MAX_FOUND];
+  record(false, 1, trace, found);
+
+  // the clock reads the last conversion until asked again, so poll() itself takes no time
+  TouchTraceReplay replay(trace.data(), trace.size());
+  Resistive_Touch_Screen tsn(&replay, 300);
+  tsn.setSettleMicros(25, 25, 25);
+  uint32_t last = 0;
+  while (!replay.finished()) {
+    tsn.poll();
+    uint32_t now = replay.micros();
+    CHECK(now >= last);
+    last = now;
+    CHECK_EQ(0, tsn.dutyCyclePermille());
+  }
+  CHECK(last >= 590000);
+}
@@ -0,0 +1,41 @@
+// Please format this file with clang before check-in to GitHub
+/*
+  File:     test_unit_test.cpp
+
+  Purpose:  Run the library's own unit_test() on the host, against the simulated panel,
+            so its fixed-point mapping checks fail the build.
+            Mapping and tap properties are in test_properties.cpp, smoothing in
+            test_smoothing.cpp.
+
+  License:  GNU General Public License v3.0
+*/
+
+#include "test.h"
+#include <Resistive_Touch_Screen.h>
+#include <Touch_Simulator.h>
+
+TEST(unit_test_default_range) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setScreenSize(320, 240);
+  CHECK_EQ(0, tsn.unit_test());
+}
+
+TEST(unit_test_in_ohms) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 300);   // pressure in ohms takes other thresholds
+  tsn.setScreenSize(320, 240);
+  CHECK_EQ(0, tsn.unit_test());
+}
+
+// the checks must hold however the acquisition is configured
+TEST(unit_test_other_acquisition_settings) {
+  SimulatedTouchPanel panel;
+  Resistive_Touch_Screen tsn(&panel, 0);
+  tsn.setScreenSize(320, 240);
+  tsn.setTapValidation(0, 0);
+  CHECK_EQ(0, tsn.unit_test());
+  tsn.setTapValidation(5, 1);
+  tsn.setOversampling(5, 3, TouchFilter::TRIMMED_MEAN);
+  CHECK_EQ(0, tsn.unit_test());
+}